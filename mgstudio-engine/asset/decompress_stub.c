@@ -0,0 +1,570 @@
+// Copyright 2026 International Digital Economy Academy
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Streaming decoders for zlib, gzip, zstd and LZ4 frames.
+//
+// A decoder never owns its input: every step is handed the caller's current
+// chunk and reports how much of it was consumed, and output goes straight
+// into the caller's buffer. The one-shot entry point sizes its result from
+// the caller's expected size or the stream's own header/trailer and decodes
+// directly into the final MoonBit allocation; only streams of unknown size
+// go through a growing scratch buffer.
+
+#include <lz4frame.h>
+#include <moonbit.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+#include <zstd.h>
+
+enum {
+  MGSTUDIO_ASSET_CODEC_ZLIB = 0,
+  MGSTUDIO_ASSET_CODEC_GZIP = 1,
+  MGSTUDIO_ASSET_CODEC_ZSTD = 2,
+  MGSTUDIO_ASSET_CODEC_LZ4 = 3,
+};
+
+enum {
+  MGSTUDIO_ASSET_DECODER_RUNNING = 0,
+  MGSTUDIO_ASSET_DECODER_DONE = 1,
+  MGSTUDIO_ASSET_DECODER_FAILED = 2,
+};
+
+typedef struct {
+  int32_t codec;
+  int32_t state;
+  // Input consumed by the last step.
+  int32_t consumed;
+  // A gzip member, zstd frame or LZ4 frame just ended; more may follow.
+  int32_t at_boundary;
+  int32_t zlib_ready;
+  z_stream zlib;
+  ZSTD_DStream *zstd;
+  LZ4F_dctx *lz4;
+} mgstudio_asset_decoder_t;
+
+static void mgstudio_asset_decoder_release(mgstudio_asset_decoder_t *decoder) {
+  if (decoder->zlib_ready) {
+    inflateEnd(&decoder->zlib);
+    decoder->zlib_ready = 0;
+  }
+  if (decoder->zstd != NULL) {
+    ZSTD_freeDStream(decoder->zstd);
+    decoder->zstd = NULL;
+  }
+  if (decoder->lz4 != NULL) {
+    LZ4F_freeDecompressionContext(decoder->lz4);
+    decoder->lz4 = NULL;
+  }
+}
+
+static void mgstudio_asset_decoder_finalize(void *ptr) {
+  mgstudio_asset_decoder_release((mgstudio_asset_decoder_t *)ptr);
+}
+
+static int mgstudio_asset_decoder_init(
+  mgstudio_asset_decoder_t *decoder,
+  int32_t codec
+) {
+  memset(decoder, 0, sizeof(mgstudio_asset_decoder_t));
+  decoder->codec = codec;
+  decoder->state = MGSTUDIO_ASSET_DECODER_RUNNING;
+  switch (codec) {
+  case MGSTUDIO_ASSET_CODEC_ZLIB:
+  case MGSTUDIO_ASSET_CODEC_GZIP: {
+    int window_bits =
+      codec == MGSTUDIO_ASSET_CODEC_GZIP ? 16 + MAX_WBITS : MAX_WBITS;
+    if (inflateInit2(&decoder->zlib, window_bits) != Z_OK) {
+      return 0;
+    }
+    decoder->zlib_ready = 1;
+    return 1;
+  }
+  case MGSTUDIO_ASSET_CODEC_ZSTD:
+    decoder->zstd = ZSTD_createDStream();
+    return decoder->zstd != NULL &&
+           !ZSTD_isError(ZSTD_initDStream(decoder->zstd));
+  case MGSTUDIO_ASSET_CODEC_LZ4:
+    return !LZ4F_isError(
+      LZ4F_createDecompressionContext(&decoder->lz4, LZ4F_VERSION)
+    );
+  default:
+    return 0;
+  }
+}
+
+static int mgstudio_asset_gzip_member_starts(const uint8_t *in, size_t len) {
+  return len >= 2 && in[0] == 0x1f && in[1] == 0x8b;
+}
+
+static void mgstudio_asset_decoder_fail(mgstudio_asset_decoder_t *decoder) {
+  decoder->state = MGSTUDIO_ASSET_DECODER_FAILED;
+}
+
+static size_t mgstudio_asset_decoder_run_zlib(
+  mgstudio_asset_decoder_t *decoder,
+  const uint8_t *in,
+  size_t in_len,
+  int end,
+  uint8_t *out,
+  size_t out_len,
+  size_t *consumed
+) {
+  z_stream *stream = &decoder->zlib;
+  stream->next_in = (Bytef *)in;
+  stream->avail_in = (uInt)in_len;
+  stream->next_out = out;
+  stream->avail_out = (uInt)out_len;
+  for (;;) {
+    if (decoder->at_boundary) {
+      // Concatenated gzip members decode as one stream; anything else after
+      // the end of a stream is ignored.
+      if (decoder->codec == MGSTUDIO_ASSET_CODEC_GZIP &&
+          mgstudio_asset_gzip_member_starts(
+            stream->next_in, stream->avail_in
+          )) {
+        inflateReset(stream);
+        decoder->at_boundary = 0;
+      } else if (stream->avail_in > 0 || end) {
+        decoder->state = MGSTUDIO_ASSET_DECODER_DONE;
+        break;
+      } else {
+        break;
+      }
+    }
+    uInt before_in = stream->avail_in;
+    uInt before_out = stream->avail_out;
+    int status = inflate(stream, Z_NO_FLUSH);
+    if (status == Z_STREAM_END) {
+      if (decoder->codec == MGSTUDIO_ASSET_CODEC_ZLIB) {
+        decoder->state = MGSTUDIO_ASSET_DECODER_DONE;
+        break;
+      }
+      decoder->at_boundary = 1;
+      continue;
+    }
+    if (status != Z_OK && status != Z_BUF_ERROR) {
+      mgstudio_asset_decoder_fail(decoder);
+      break;
+    }
+    if (stream->avail_out == 0) {
+      break;
+    }
+    if (stream->avail_in == before_in && stream->avail_out == before_out) {
+      if (end && stream->avail_in == 0) {
+        // Input ran out in the middle of a stream.
+        mgstudio_asset_decoder_fail(decoder);
+      }
+      break;
+    }
+  }
+  *consumed = in_len - stream->avail_in;
+  return out_len - stream->avail_out;
+}
+
+static size_t mgstudio_asset_decoder_run_zstd(
+  mgstudio_asset_decoder_t *decoder,
+  const uint8_t *in,
+  size_t in_len,
+  int end,
+  uint8_t *out,
+  size_t out_len,
+  size_t *consumed
+) {
+  ZSTD_inBuffer input = {in, in_len, 0};
+  ZSTD_outBuffer output = {out, out_len, 0};
+  for (;;) {
+    if (decoder->at_boundary && input.pos == input.size) {
+      if (end) {
+        decoder->state = MGSTUDIO_ASSET_DECODER_DONE;
+      }
+      break;
+    }
+    size_t before_in = input.pos;
+    size_t before_out = output.pos;
+    size_t hint = ZSTD_decompressStream(decoder->zstd, &output, &input);
+    if (ZSTD_isError(hint)) {
+      mgstudio_asset_decoder_fail(decoder);
+      break;
+    }
+    // 0: the frame is complete and fully flushed.
+    decoder->at_boundary = hint == 0;
+    if (decoder->at_boundary) {
+      continue;
+    }
+    if (output.pos == output.size) {
+      break;
+    }
+    if (input.pos == before_in && output.pos == before_out) {
+      if (end && input.pos == input.size) {
+        mgstudio_asset_decoder_fail(decoder);
+      }
+      break;
+    }
+  }
+  *consumed = input.pos;
+  return output.pos;
+}
+
+static size_t mgstudio_asset_decoder_run_lz4(
+  mgstudio_asset_decoder_t *decoder,
+  const uint8_t *in,
+  size_t in_len,
+  int end,
+  uint8_t *out,
+  size_t out_len,
+  size_t *consumed
+) {
+  size_t in_pos = 0;
+  size_t out_pos = 0;
+  for (;;) {
+    if (decoder->at_boundary && in_pos == in_len) {
+      if (end) {
+        decoder->state = MGSTUDIO_ASSET_DECODER_DONE;
+      }
+      break;
+    }
+    size_t src_size = in_len - in_pos;
+    size_t dst_size = out_len - out_pos;
+    size_t hint = LZ4F_decompress(
+      decoder->lz4, out + out_pos, &dst_size, in + in_pos, &src_size, NULL
+    );
+    if (LZ4F_isError(hint)) {
+      mgstudio_asset_decoder_fail(decoder);
+      break;
+    }
+    in_pos += src_size;
+    out_pos += dst_size;
+    // 0: the frame is complete (checksums included) and fully flushed.
+    decoder->at_boundary = hint == 0;
+    if (decoder->at_boundary) {
+      continue;
+    }
+    if (out_pos == out_len) {
+      break;
+    }
+    if (src_size == 0 && dst_size == 0) {
+      if (end && in_pos == in_len) {
+        mgstudio_asset_decoder_fail(decoder);
+      }
+      break;
+    }
+  }
+  *consumed = in_pos;
+  return out_pos;
+}
+
+// One decode step: consumes from `in` and writes at most `out_len` bytes to
+// `out`. `end` says `in` holds the last of the input. Returns the number of
+// bytes written.
+static size_t mgstudio_asset_decoder_run(
+  mgstudio_asset_decoder_t *decoder,
+  const uint8_t *in,
+  size_t in_len,
+  int end,
+  uint8_t *out,
+  size_t out_len,
+  size_t *consumed
+) {
+  *consumed = 0;
+  if (decoder->state != MGSTUDIO_ASSET_DECODER_RUNNING) {
+    return 0;
+  }
+  switch (decoder->codec) {
+  case MGSTUDIO_ASSET_CODEC_ZLIB:
+  case MGSTUDIO_ASSET_CODEC_GZIP:
+    return mgstudio_asset_decoder_run_zlib(
+      decoder, in, in_len, end, out, out_len, consumed
+    );
+  case MGSTUDIO_ASSET_CODEC_ZSTD:
+    return mgstudio_asset_decoder_run_zstd(
+      decoder, in, in_len, end, out, out_len, consumed
+    );
+  case MGSTUDIO_ASSET_CODEC_LZ4:
+    return mgstudio_asset_decoder_run_lz4(
+      decoder, in, in_len, end, out, out_len, consumed
+    );
+  default:
+    mgstudio_asset_decoder_fail(decoder);
+    return 0;
+  }
+}
+
+MOONBIT_FFI_EXPORT
+mgstudio_asset_decoder_t *mgstudio_asset_decoder_new(int32_t codec) {
+  mgstudio_asset_decoder_t *decoder =
+    (mgstudio_asset_decoder_t *)moonbit_make_external_object(
+      mgstudio_asset_decoder_finalize,
+      (uint32_t)sizeof(mgstudio_asset_decoder_t)
+    );
+  if (!mgstudio_asset_decoder_init(decoder, codec)) {
+    mgstudio_asset_decoder_release(decoder);
+    mgstudio_asset_decoder_fail(decoder);
+  }
+  return decoder;
+}
+
+// Decodes from `input[in_offset, in_offset + in_len)` into
+// `output[out_offset, out_offset + out_len)`. Returns the bytes written, or
+// -1 for out-of-range arguments; `consumed` and `state` report the rest.
+MOONBIT_FFI_EXPORT
+int32_t mgstudio_asset_decoder_step(
+  mgstudio_asset_decoder_t *decoder,
+  moonbit_bytes_t input,
+  int32_t in_offset,
+  int32_t in_len,
+  int32_t end,
+  moonbit_bytes_t output,
+  int32_t out_offset,
+  int32_t out_len
+) {
+  decoder->consumed = 0;
+  const uint32_t input_size = Moonbit_array_length(input);
+  const uint32_t output_size = Moonbit_array_length(output);
+  if (in_offset < 0 || in_len < 0 ||
+      (uint32_t)in_offset > input_size ||
+      (uint32_t)in_len > input_size - (uint32_t)in_offset ||
+      out_offset < 0 || out_len < 0 ||
+      (uint32_t)out_offset > output_size ||
+      (uint32_t)out_len > output_size - (uint32_t)out_offset) {
+    return -1;
+  }
+  size_t consumed = 0;
+  size_t written = mgstudio_asset_decoder_run(
+    decoder,
+    input + in_offset,
+    (size_t)in_len,
+    end != 0,
+    output + out_offset,
+    (size_t)out_len,
+    &consumed
+  );
+  decoder->consumed = (int32_t)consumed;
+  return (int32_t)written;
+}
+
+MOONBIT_FFI_EXPORT
+int32_t mgstudio_asset_decoder_consumed(mgstudio_asset_decoder_t *decoder) {
+  return decoder->consumed;
+}
+
+MOONBIT_FFI_EXPORT
+int32_t mgstudio_asset_decoder_state(mgstudio_asset_decoder_t *decoder) {
+  return decoder->state;
+}
+
+// Decoded size recorded by the stream itself, or -1. Only a hint: a gzip
+// ISIZE covers the last member modulo 2^32, and zstd/LZ4 sizes cover the
+// first frame, so results are always checked against the actual decode.
+static int64_t mgstudio_asset_decoded_size_hint(
+  int32_t codec,
+  const uint8_t *in,
+  size_t len
+) {
+  switch (codec) {
+  case MGSTUDIO_ASSET_CODEC_GZIP:
+    if (len < 18 || !mgstudio_asset_gzip_member_starts(in, len)) {
+      return -1;
+    }
+    {
+      int64_t size = (int64_t)((uint32_t)in[len - 4] |
+                               ((uint32_t)in[len - 3] << 8) |
+                               ((uint32_t)in[len - 2] << 16) |
+                               ((uint32_t)in[len - 1] << 24));
+      // Deflate cannot expand past 1032:1, so a larger ISIZE is damage.
+      return size > (int64_t)INT32_MAX || size > (int64_t)len * 1032
+               ? -1
+               : size;
+    }
+  case MGSTUDIO_ASSET_CODEC_ZSTD: {
+    unsigned long long size = ZSTD_getFrameContentSize(in, len);
+    if (size == ZSTD_CONTENTSIZE_UNKNOWN || size == ZSTD_CONTENTSIZE_ERROR ||
+        size > (unsigned long long)INT32_MAX) {
+      return -1;
+    }
+    // A frame header can claim any size up front, so trust it only up to
+    // 1032:1 or 64 MiB and leave anything larger to the growing decode.
+    if (size > (unsigned long long)len * 1032u && size > (64ull << 20)) {
+      return -1;
+    }
+    return (int64_t)size;
+  }
+  case MGSTUDIO_ASSET_CODEC_LZ4: {
+    // Magic, FLG, BD, then the 8-byte content size when FLG bit 3 is set.
+    if (len < 15 || in[0] != 0x04 || in[1] != 0x22 || in[2] != 0x4d ||
+        in[3] != 0x18 || (in[4] & 0x08) == 0) {
+      return -1;
+    }
+    uint64_t size = 0;
+    for (int i = 7; i >= 0; i--) {
+      size = (size << 8) | in[6 + i];
+    }
+    // LZ4 cannot expand past 255:1.
+    return size > (uint64_t)INT32_MAX || size > (uint64_t)len * 255u
+             ? -1
+             : (int64_t)size;
+  }
+  default:
+    return -1;
+  }
+}
+
+// Decodes all of `in` into exactly `out_len` bytes at `out`. Returns 1 when
+// the stream ends there, covers all of the input and fills `out`.
+MOONBIT_FFI_EXPORT
+int32_t mgstudio_asset_decompress_into(
+  int32_t codec,
+  const uint8_t *in,
+  size_t in_len,
+  uint8_t *out,
+  size_t out_len
+) {
+  mgstudio_asset_decoder_t decoder;
+  if (!mgstudio_asset_decoder_init(&decoder, codec)) {
+    mgstudio_asset_decoder_release(&decoder);
+    return 0;
+  }
+  size_t consumed = 0;
+  size_t written =
+    mgstudio_asset_decoder_run(&decoder, in, in_len, 1, out, out_len, &consumed);
+  int ok = written == out_len;
+  if (ok && decoder.state == MGSTUDIO_ASSET_DECODER_RUNNING) {
+    // `out` is full; the stream must end without producing more.
+    uint8_t probe = 0;
+    size_t more = 0;
+    size_t extra = mgstudio_asset_decoder_run(
+      &decoder, in + consumed, in_len - consumed, 1, &probe, 1, &more
+    );
+    consumed += more;
+    ok = extra == 0;
+  }
+  ok = ok && decoder.state == MGSTUDIO_ASSET_DECODER_DONE && consumed == in_len;
+  mgstudio_asset_decoder_release(&decoder);
+  return ok;
+}
+
+// Unknown output size: decode through a doubling scratch buffer.
+static moonbit_bytes_t mgstudio_asset_decompress_grow(
+  int32_t codec,
+  const uint8_t *in,
+  size_t in_len
+) {
+  mgstudio_asset_decoder_t decoder;
+  if (!mgstudio_asset_decoder_init(&decoder, codec)) {
+    mgstudio_asset_decoder_release(&decoder);
+    return moonbit_make_bytes(0, 0);
+  }
+  size_t capacity = in_len * 4u;
+  if (capacity < 4096u) {
+    capacity = 4096u;
+  }
+  uint8_t *buffer = (uint8_t *)malloc(capacity);
+  size_t in_pos = 0;
+  size_t out_pos = 0;
+  while (buffer != NULL &&
+         decoder.state == MGSTUDIO_ASSET_DECODER_RUNNING) {
+    if (out_pos == capacity) {
+      if (capacity > (size_t)INT32_MAX / 2u) {
+        break;
+      }
+      uint8_t *grown = (uint8_t *)realloc(buffer, capacity * 2u);
+      if (grown == NULL) {
+        break;
+      }
+      buffer = grown;
+      capacity *= 2u;
+    }
+    size_t consumed = 0;
+    size_t written = mgstudio_asset_decoder_run(
+      &decoder,
+      in + in_pos,
+      in_len - in_pos,
+      1,
+      buffer + out_pos,
+      capacity - out_pos,
+      &consumed
+    );
+    in_pos += consumed;
+    out_pos += written;
+    if (written == 0 && consumed == 0 && out_pos < capacity) {
+      break;
+    }
+  }
+  int ok = buffer != NULL && decoder.state == MGSTUDIO_ASSET_DECODER_DONE;
+  mgstudio_asset_decoder_release(&decoder);
+  if (!ok) {
+    free(buffer);
+    return moonbit_make_bytes(0, 0);
+  }
+  moonbit_bytes_t output = moonbit_make_bytes((int32_t)out_pos, 0);
+  if (out_pos > 0) {
+    memcpy(output, buffer, out_pos);
+  }
+  free(buffer);
+  return output;
+}
+
+// Decodes `input[offset, offset + len)` in one go. `expected` is the decoded
+// size when the caller knows it (-1 otherwise); a stream that does not
+// decode to exactly that size fails. Failure returns empty bytes.
+MOONBIT_FFI_EXPORT
+moonbit_bytes_t mgstudio_asset_decompress(
+  int32_t codec,
+  moonbit_bytes_t input,
+  int32_t offset,
+  int32_t len,
+  int32_t expected
+) {
+  const uint32_t input_size = Moonbit_array_length(input);
+  if (offset < 0 || len < 0 || (uint32_t)offset > input_size ||
+      (uint32_t)len > input_size - (uint32_t)offset) {
+    return moonbit_make_bytes(0, 0);
+  }
+  const uint8_t *in = input + offset;
+  int64_t size = expected >= 0
+                   ? (int64_t)expected
+                   : mgstudio_asset_decoded_size_hint(codec, in, (size_t)len);
+  if (size == 0) {
+    uint8_t none = 0;
+    if (mgstudio_asset_decompress_into(codec, in, (size_t)len, &none, 0) ||
+        expected >= 0) {
+      return moonbit_make_bytes(0, 0);
+    }
+  } else if (size > 0) {
+    moonbit_bytes_t output = moonbit_make_bytes((int32_t)size, 0);
+    if (mgstudio_asset_decompress_into(
+          codec, in, (size_t)len, output, (size_t)size
+        )) {
+      return output;
+    }
+    if (expected >= 0) {
+      return moonbit_make_bytes(0, 0);
+    }
+    // The stream's own size was wrong (e.g. several members); fall through.
+  }
+  return mgstudio_asset_decompress_grow(codec, in, (size_t)len);
+}
+
+// Kept for callers that only ever need one-shot gzip.
+MOONBIT_FFI_EXPORT moonbit_bytes_t
+mgstudio_asset_gzip_decompress(moonbit_bytes_t input) {
+  return mgstudio_asset_decompress(
+    MGSTUDIO_ASSET_CODEC_GZIP,
+    input,
+    0,
+    (int32_t)Moonbit_array_length(input),
+    -1
+  );
+}
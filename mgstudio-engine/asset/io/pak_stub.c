@@ -0,0 +1,264 @@
+// Copyright 2026 International Digital Economy Academy
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Backing storage for `.mgpak` archives. On POSIX hosts the archive is mapped
+// read-only, so opening it costs one open/fstat/mmap regardless of how many
+// entries it holds and only the pages that are actually read become resident.
+// Hosts without mmap (or a failing mmap) fall back to reading the file into
+// one heap block; the MoonBit side sees the same handle either way.
+
+#include <moonbit.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+#include <zstd.h>
+
+#if !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+typedef struct {
+  uint8_t *data;
+  size_t len;
+  int32_t open;
+  int32_t mapped;
+} mgstudio_asset_pak_t;
+
+static void mgstudio_asset_pak_finalize(void *ptr) {
+  mgstudio_asset_pak_t *pak = (mgstudio_asset_pak_t *)ptr;
+  if (pak->data == NULL) {
+    return;
+  }
+#if !defined(_WIN32)
+  if (pak->mapped) {
+    munmap(pak->data, pak->len);
+    pak->data = NULL;
+    return;
+  }
+#endif
+  free(pak->data);
+  pak->data = NULL;
+}
+
+static int mgstudio_asset_pak_read_whole(
+  mgstudio_asset_pak_t *pak,
+  const char *path
+) {
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    return 0;
+  }
+  if (fseek(file, 0, SEEK_END) != 0) {
+    fclose(file);
+    return 0;
+  }
+  long len = ftell(file);
+  if (len < 0 || fseek(file, 0, SEEK_SET) != 0) {
+    fclose(file);
+    return 0;
+  }
+  uint8_t *data = (uint8_t *)malloc(len > 0 ? (size_t)len : 1u);
+  if (data == NULL) {
+    fclose(file);
+    return 0;
+  }
+  if (len > 0 && fread(data, 1, (size_t)len, file) != (size_t)len) {
+    free(data);
+    fclose(file);
+    return 0;
+  }
+  fclose(file);
+  pak->data = data;
+  pak->len = (size_t)len;
+  pak->mapped = 0;
+  return 1;
+}
+
+#if !defined(_WIN32)
+static int mgstudio_asset_pak_map(mgstudio_asset_pak_t *pak, const char *path) {
+  int fd = open(path, O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return 0;
+  }
+  struct stat info;
+  if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+    close(fd);
+    return 0;
+  }
+  void *data = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+  // The mapping keeps its own reference to the file.
+  close(fd);
+  if (data == MAP_FAILED) {
+    return 0;
+  }
+  pak->data = (uint8_t *)data;
+  pak->len = (size_t)info.st_size;
+  pak->mapped = 1;
+  return 1;
+}
+#endif
+
+// `path` is NUL-terminated UTF-8. A handle whose open failed reports
+// `is_open == 0` and has no data.
+MOONBIT_FFI_EXPORT
+mgstudio_asset_pak_t *mgstudio_asset_pak_open(moonbit_bytes_t path) {
+  mgstudio_asset_pak_t *pak =
+    (mgstudio_asset_pak_t *)moonbit_make_external_object(
+      mgstudio_asset_pak_finalize,
+      (uint32_t)sizeof(mgstudio_asset_pak_t)
+    );
+  memset(pak, 0, sizeof(mgstudio_asset_pak_t));
+  const char *c_path = (const char *)path;
+#if !defined(_WIN32)
+  if (mgstudio_asset_pak_map(pak, c_path)) {
+    pak->open = 1;
+    return pak;
+  }
+#endif
+  pak->open = mgstudio_asset_pak_read_whole(pak, c_path);
+  return pak;
+}
+
+MOONBIT_FFI_EXPORT
+int32_t mgstudio_asset_pak_is_open(mgstudio_asset_pak_t *pak) {
+  return pak->open;
+}
+
+MOONBIT_FFI_EXPORT
+int32_t mgstudio_asset_pak_is_mapped(mgstudio_asset_pak_t *pak) {
+  return pak->mapped;
+}
+
+MOONBIT_FFI_EXPORT
+int64_t mgstudio_asset_pak_length(mgstudio_asset_pak_t *pak) {
+  return (int64_t)pak->len;
+}
+
+static int mgstudio_asset_pak_range_ok(
+  mgstudio_asset_pak_t *pak,
+  int64_t offset,
+  int32_t len
+) {
+  return pak->data != NULL && offset >= 0 && len >= 0 &&
+         (uint64_t)offset <= (uint64_t)pak->len &&
+         (uint64_t)len <= (uint64_t)pak->len - (uint64_t)offset;
+}
+
+// Copies `len` bytes at `offset` out of the archive. Out-of-range requests
+// return empty bytes.
+MOONBIT_FFI_EXPORT
+moonbit_bytes_t mgstudio_asset_pak_copy(
+  mgstudio_asset_pak_t *pak,
+  int64_t offset,
+  int32_t len
+) {
+  if (!mgstudio_asset_pak_range_ok(pak, offset, len) || len == 0) {
+    return moonbit_make_bytes(0, 0);
+  }
+  moonbit_bytes_t output = moonbit_make_bytes(len, 0);
+  memcpy(output, pak->data + offset, (size_t)len);
+  return output;
+}
+
+// Shared with the asset package's decoders (asset/decompress_stub.c).
+int32_t mgstudio_asset_decompress_into(
+  int32_t codec,
+  const uint8_t *in,
+  size_t in_len,
+  uint8_t *out,
+  size_t out_len
+);
+
+// Decodes a compressed entry straight from the mapping into a `size`-byte
+// result. `compression` is the on-disk code: 1 zlib, 2 zstd. Returns empty
+// bytes when the data is damaged or does not decode to exactly `size` bytes.
+MOONBIT_FFI_EXPORT
+moonbit_bytes_t mgstudio_asset_pak_decompress(
+  mgstudio_asset_pak_t *pak,
+  int32_t compression,
+  int64_t offset,
+  int32_t stored,
+  int32_t size
+) {
+  if (!mgstudio_asset_pak_range_ok(pak, offset, stored) || size <= 0 ||
+      (compression != 1 && compression != 2)) {
+    return moonbit_make_bytes(0, 0);
+  }
+  // Codec ids of mgstudio_asset_decoder_t: 0 zlib, 2 zstd.
+  int32_t codec = compression == 1 ? 0 : 2;
+  moonbit_bytes_t output = moonbit_make_bytes(size, 0);
+  if (!mgstudio_asset_decompress_into(
+        codec, pak->data + offset, (size_t)stored, output, (size_t)size
+      )) {
+    return moonbit_make_bytes(0, 0);
+  }
+  return output;
+}
+
+// zstd-compresses `input` for the archive writer. Returns empty bytes on
+// failure; the writer then stores the entry uncompressed.
+MOONBIT_FFI_EXPORT
+moonbit_bytes_t mgstudio_asset_pak_zstd_compress(
+  moonbit_bytes_t input,
+  int32_t level
+) {
+  const uint32_t input_len = Moonbit_array_length(input);
+  if (input_len == 0) {
+    return moonbit_make_bytes(0, 0);
+  }
+  size_t capacity = ZSTD_compressBound((size_t)input_len);
+  uint8_t *buffer = (uint8_t *)malloc(capacity);
+  if (buffer == NULL) {
+    return moonbit_make_bytes(0, 0);
+  }
+  size_t out_len =
+    ZSTD_compress(buffer, capacity, input, (size_t)input_len, level);
+  if (ZSTD_isError(out_len)) {
+    free(buffer);
+    return moonbit_make_bytes(0, 0);
+  }
+  moonbit_bytes_t output = moonbit_make_bytes((int32_t)out_len, 0);
+  memcpy(output, buffer, out_len);
+  free(buffer);
+  return output;
+}
+
+// zlib-compresses `input` for the archive writer. Returns empty bytes on
+// failure; the writer then stores the entry uncompressed.
+MOONBIT_FFI_EXPORT
+moonbit_bytes_t mgstudio_asset_pak_deflate(moonbit_bytes_t input) {
+  const uint32_t input_len = Moonbit_array_length(input);
+  if (input_len == 0) {
+    return moonbit_make_bytes(0, 0);
+  }
+  uLongf capacity = compressBound((uLong)input_len);
+  uint8_t *buffer = (uint8_t *)malloc((size_t)capacity);
+  if (buffer == NULL) {
+    return moonbit_make_bytes(0, 0);
+  }
+  uLongf out_len = capacity;
+  if (compress2(buffer, &out_len, input, (uLong)input_len, 6) != Z_OK) {
+    free(buffer);
+    return moonbit_make_bytes(0, 0);
+  }
+  moonbit_bytes_t output = moonbit_make_bytes((int32_t)out_len, 0);
+  memcpy(output, buffer, (size_t)out_len);
+  free(buffer);
+  return output;
+}
@@ -0,0 +1,660 @@
+// Copyright 2026 International Digital Economy Academy
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Mip level generation for RGBA8 images.
+//
+// Every level is built from the previous one and filled row range by row
+// range on the compute pool (`mgstudio_tasks_parallel_for` in
+// `tasks/worker_pool_stub.c`). Levels are either produced one call at a time
+// into MoonBit bytes allocated on the calling thread, or as a whole chain by
+// a detached task on the async compute pool, so image loads build their
+// chains off the frame thread and several chains run side by side.
+//
+// Filtering happens in linear light when the data is sRGB-encoded and always
+// on alpha-premultiplied colour, so transparent texels do not bleed their
+// colour into visible ones. Where the result is fully transparent the
+// straight average of the source block is kept instead, which avoids dark
+// fringes when the level is sampled with straight alpha. Optionally the alpha channel is
+// rescaled so the fraction of texels passing an alpha-test cutoff matches the
+// base level (alpha-tested foliage otherwise thins out with distance).
+
+#include <limits.h>
+#include <math.h>
+#include <moonbit.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define MGSTUDIO_TASKS_POOL_ASYNC_COMPUTE 1
+
+#define MGSTUDIO_ASSET_MIP_FILTER_BOX 0
+#define MGSTUDIO_ASSET_MIP_FILTER_KAISER 1
+#define MGSTUDIO_ASSET_MIP_FILTER_LANCZOS 2
+
+// Filter radius in destination texels for the windowed-sinc filters.
+#define MGSTUDIO_ASSET_MIP_SUPPORT 3.0
+#define MGSTUDIO_ASSET_MIP_KAISER_ALPHA 4.0
+// Roughly this many destination texels per parallel_for range. Separable
+// ranges are at least this many rows tall so the source rows shared with the
+// neighbouring ranges (filtered twice) stay a small fraction.
+#define MGSTUDIO_ASSET_MIP_TEXELS_PER_RANGE 16384
+#define MGSTUDIO_ASSET_MIP_SEPARABLE_MIN_ROWS 32
+#define MGSTUDIO_ASSET_MIP_ENCODE_STEPS 4096
+#define MGSTUDIO_ASSET_MIP_PI 3.14159265358979323846
+
+typedef void (*mgstudio_tasks_range_fn)(void *arg, int32_t begin, int32_t end);
+
+extern void mgstudio_tasks_parallel_for(int32_t count,
+                                        int32_t grain,
+                                        mgstudio_tasks_range_fn run,
+                                        void *arg);
+
+static float mgstudio_asset_mip_srgb_decode[256];
+static uint8_t
+  mgstudio_asset_mip_srgb_encode[MGSTUDIO_ASSET_MIP_ENCODE_STEPS + 1];
+static pthread_once_t mgstudio_asset_mip_tables_once = PTHREAD_ONCE_INIT;
+
+static void mgstudio_asset_mip_init_tables(void) {
+  for (int i = 0; i < 256; i += 1) {
+    double c = (double)i / 255.0;
+    mgstudio_asset_mip_srgb_decode[i] =
+      (float)(c <= 0.04045 ? c / 12.92 : pow((c + 0.055) / 1.055, 2.4));
+  }
+  for (int i = 0; i <= MGSTUDIO_ASSET_MIP_ENCODE_STEPS; i += 1) {
+    double l = (double)i / (double)MGSTUDIO_ASSET_MIP_ENCODE_STEPS;
+    double c =
+      l <= 0.0031308 ? l * 12.92 : 1.055 * pow(l, 1.0 / 2.4) - 0.055;
+    mgstudio_asset_mip_srgb_encode[i] = (uint8_t)(c * 255.0 + 0.5);
+  }
+}
+
+static inline float mgstudio_asset_mip_clamp01(float v) {
+  return v < 0.0f ? 0.0f : (v > 1.0f ? 1.0f : v);
+}
+
+typedef struct {
+  const uint8_t *src;
+  uint8_t *dst;
+  int32_t src_w;
+  int32_t src_h;
+  int32_t dst_w;
+  int32_t dst_h;
+  int32_t srgb;
+  // Separable filters: destination texel `i` reads the `taps_*` (index,
+  // weight) pairs starting at `i * taps_*`.
+  int32_t taps_x;
+  int32_t taps_y;
+  int32_t *x_index;
+  float *x_weight;
+  int32_t *y_index;
+  float *y_weight;
+  atomic_int failed;
+} mgstudio_asset_mip_job_t;
+
+static inline float mgstudio_asset_mip_decode(int32_t srgb, uint8_t v) {
+  return srgb ? mgstudio_asset_mip_srgb_decode[v] : (float)v * (1.0f / 255.0f);
+}
+
+static inline uint8_t mgstudio_asset_mip_encode(int32_t srgb, float v) {
+  v = mgstudio_asset_mip_clamp01(v);
+  if (srgb) {
+    int32_t step =
+      (int32_t)(v * (float)MGSTUDIO_ASSET_MIP_ENCODE_STEPS + 0.5f);
+    return mgstudio_asset_mip_srgb_encode[step];
+  }
+  return (uint8_t)(v * 255.0f + 0.5f);
+}
+
+// Expands one texel into premultiplied linear rgb and alpha.
+static inline void mgstudio_asset_mip_expand(
+  int32_t srgb,
+  const uint8_t *texel,
+  float *out
+) {
+  float a = (float)texel[3] * (1.0f / 255.0f);
+  out[0] = mgstudio_asset_mip_decode(srgb, texel[0]) * a;
+  out[1] = mgstudio_asset_mip_decode(srgb, texel[1]) * a;
+  out[2] = mgstudio_asset_mip_decode(srgb, texel[2]) * a;
+  out[3] = a;
+}
+
+// Writes destination texel (`x`, `y`) from its premultiplied accumulator.
+// When the filtered alpha rounds to zero the colour falls back to the
+// straight average of the 2x2 source block under the texel.
+static inline void mgstudio_asset_mip_store(
+  const mgstudio_asset_mip_job_t *job,
+  const float *acc,
+  int32_t x,
+  int32_t y
+) {
+  const int32_t srgb = job->srgb;
+  uint8_t *texel = job->dst + ((size_t)y * (size_t)job->dst_w + (size_t)x) * 4u;
+  float a = mgstudio_asset_mip_clamp01(acc[3]);
+  texel[3] = (uint8_t)(a * 255.0f + 0.5f);
+  if (texel[3] != 0) {
+    float inv = 1.0f / a;
+    texel[0] = mgstudio_asset_mip_encode(srgb, acc[0] * inv);
+    texel[1] = mgstudio_asset_mip_encode(srgb, acc[1] * inv);
+    texel[2] = mgstudio_asset_mip_encode(srgb, acc[2] * inv);
+    return;
+  }
+  int32_t x0 = x * 2 < job->src_w - 1 ? x * 2 : job->src_w - 1;
+  int32_t x1 = x0 + 1 < job->src_w - 1 ? x0 + 1 : job->src_w - 1;
+  int32_t y0 = y * 2 < job->src_h - 1 ? y * 2 : job->src_h - 1;
+  int32_t y1 = y0 + 1 < job->src_h - 1 ? y0 + 1 : job->src_h - 1;
+  const size_t stride = (size_t)job->src_w;
+  const uint8_t *corners[4] = {
+    job->src + ((size_t)y0 * stride + (size_t)x0) * 4u,
+    job->src + ((size_t)y0 * stride + (size_t)x1) * 4u,
+    job->src + ((size_t)y1 * stride + (size_t)x0) * 4u,
+    job->src + ((size_t)y1 * stride + (size_t)x1) * 4u,
+  };
+  for (int c = 0; c < 3; c += 1) {
+    float sum = 0.0f;
+    for (int i = 0; i < 4; i += 1) {
+      sum += mgstudio_asset_mip_decode(srgb, corners[i][c]);
+    }
+    texel[c] = mgstudio_asset_mip_encode(srgb, sum * 0.25f);
+  }
+}
+
+// 2x2 box filter with GPU mip sizing: odd trailing rows and columns are
+// folded into the clamp, matching the previous MoonBit implementation.
+static void mgstudio_asset_mip_box_rows(void *raw, int32_t begin, int32_t end) {
+  mgstudio_asset_mip_job_t *job = (mgstudio_asset_mip_job_t *)raw;
+  const int32_t srgb = job->srgb;
+  const size_t src_stride = (size_t)job->src_w * 4u;
+  for (int32_t y = begin; y < end; y += 1) {
+    int32_t y0 = y * 2 < job->src_h - 1 ? y * 2 : job->src_h - 1;
+    int32_t y1 = y0 + 1 < job->src_h - 1 ? y0 + 1 : job->src_h - 1;
+    const uint8_t *row0 = job->src + (size_t)y0 * src_stride;
+    const uint8_t *row1 = job->src + (size_t)y1 * src_stride;
+    for (int32_t x = 0; x < job->dst_w; x += 1) {
+      int32_t x0 = x * 2 < job->src_w - 1 ? x * 2 : job->src_w - 1;
+      int32_t x1 = x0 + 1 < job->src_w - 1 ? x0 + 1 : job->src_w - 1;
+      const uint8_t *corners[4] = {
+        row0 + (size_t)x0 * 4u,
+        row0 + (size_t)x1 * 4u,
+        row1 + (size_t)x0 * 4u,
+        row1 + (size_t)x1 * 4u,
+      };
+      float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+      if ((corners[0][3] & corners[1][3] & corners[2][3] & corners[3][3]) ==
+          255) {
+        // Opaque block: premultiplying is the identity.
+        for (int c = 0; c < 3; c += 1) {
+          acc[c] = (mgstudio_asset_mip_decode(srgb, corners[0][c]) +
+                    mgstudio_asset_mip_decode(srgb, corners[1][c]) +
+                    mgstudio_asset_mip_decode(srgb, corners[2][c]) +
+                    mgstudio_asset_mip_decode(srgb, corners[3][c])) *
+                   0.25f;
+        }
+        acc[3] = 1.0f;
+      } else {
+        float texel[4];
+        for (int i = 0; i < 4; i += 1) {
+          mgstudio_asset_mip_expand(srgb, corners[i], texel);
+          for (int c = 0; c < 4; c += 1) {
+            acc[c] += texel[c] * 0.25f;
+          }
+        }
+      }
+      mgstudio_asset_mip_store(job, acc, x, y);
+    }
+  }
+}
+
+static double mgstudio_asset_mip_sinc(double x) {
+  if (fabs(x) < 1e-8) {
+    return 1.0;
+  }
+  double px = MGSTUDIO_ASSET_MIP_PI * x;
+  return sin(px) / px;
+}
+
+static double mgstudio_asset_mip_bessel_i0(double x) {
+  double sum = 1.0;
+  double term = 1.0;
+  double half = x * 0.5;
+  for (int k = 1; k < 32; k += 1) {
+    term *= (half / (double)k) * (half / (double)k);
+    sum += term;
+    if (term < sum * 1e-12) {
+      break;
+    }
+  }
+  return sum;
+}
+
+static double mgstudio_asset_mip_kernel(int32_t filter, double x) {
+  double r = MGSTUDIO_ASSET_MIP_SUPPORT;
+  if (fabs(x) >= r) {
+    return 0.0;
+  }
+  if (filter == MGSTUDIO_ASSET_MIP_FILTER_LANCZOS) {
+    return mgstudio_asset_mip_sinc(x) * mgstudio_asset_mip_sinc(x / r);
+  }
+  double t = x / r;
+  double alpha = MGSTUDIO_ASSET_MIP_KAISER_ALPHA;
+  return mgstudio_asset_mip_sinc(x) *
+         mgstudio_asset_mip_bessel_i0(alpha * sqrt(1.0 - t * t)) /
+         mgstudio_asset_mip_bessel_i0(alpha);
+}
+
+// Builds the normalized taps resampling `src_len` texels to `dst_len`. Edge
+// taps are clamped onto the border texel. Returns the tap count per
+// destination texel, or 0 when allocation failed.
+static int32_t mgstudio_asset_mip_axis(
+  int32_t filter,
+  int32_t src_len,
+  int32_t dst_len,
+  int32_t **index_out,
+  float **weight_out
+) {
+  double scale = (double)src_len / (double)dst_len;
+  double radius = MGSTUDIO_ASSET_MIP_SUPPORT * scale;
+  int32_t taps = (int32_t)ceil(radius) * 2 + 2;
+  int32_t *index = (int32_t *)malloc(sizeof(int32_t) * (size_t)taps *
+                                     (size_t)dst_len);
+  float *weight =
+    (float *)malloc(sizeof(float) * (size_t)taps * (size_t)dst_len);
+  if (index == NULL || weight == NULL) {
+    free(index);
+    free(weight);
+    return 0;
+  }
+  for (int32_t i = 0; i < dst_len; i += 1) {
+    double center = ((double)i + 0.5) * scale;
+    int32_t first = (int32_t)floor(center - radius);
+    double sum = 0.0;
+    for (int32_t t = 0; t < taps; t += 1) {
+      int32_t j = first + t;
+      double x = ((double)j + 0.5 - center) / scale;
+      double w = mgstudio_asset_mip_kernel(filter, x);
+      index[i * taps + t] = j < 0 ? 0 : (j >= src_len ? src_len - 1 : j);
+      weight[i * taps + t] = (float)w;
+      sum += w;
+    }
+    for (int32_t t = 0; t < taps; t += 1) {
+      weight[i * taps + t] =
+        sum != 0.0 ? (float)(weight[i * taps + t] / sum) : 0.0f;
+    }
+  }
+  *index_out = index;
+  *weight_out = weight;
+  return taps;
+}
+
+// Separable resampling of a destination row range. The range filters the
+// source rows it needs horizontally into a private scratch block, then
+// combines them vertically, so scratch stays proportional to the range
+// rather than to the image.
+static void mgstudio_asset_mip_separable_rows(
+  void *raw,
+  int32_t begin,
+  int32_t end
+) {
+  mgstudio_asset_mip_job_t *job = (mgstudio_asset_mip_job_t *)raw;
+  const int32_t srgb = job->srgb;
+  const int32_t taps_x = job->taps_x;
+  const int32_t taps_y = job->taps_y;
+  const int32_t dst_w = job->dst_w;
+  int32_t lo = INT32_MAX;
+  int32_t hi = -1;
+  for (int32_t y = begin; y < end; y += 1) {
+    for (int32_t t = 0; t < taps_y; t += 1) {
+      int32_t j = job->y_index[y * taps_y + t];
+      lo = j < lo ? j : lo;
+      hi = j > hi ? j : hi;
+    }
+  }
+  size_t rows = (size_t)(hi - lo + 1);
+  float *scratch = (float *)malloc(sizeof(float) * 4u * rows * (size_t)dst_w);
+  float *line = (float *)malloc(sizeof(float) * 4u * (size_t)job->src_w);
+  if (scratch == NULL || line == NULL) {
+    free(scratch);
+    free(line);
+    atomic_store(&job->failed, 1);
+    return;
+  }
+  for (int32_t sy = lo; sy <= hi; sy += 1) {
+    const uint8_t *src = job->src + (size_t)sy * (size_t)job->src_w * 4u;
+    for (int32_t x = 0; x < job->src_w; x += 1) {
+      mgstudio_asset_mip_expand(srgb, src + (size_t)x * 4u, line + x * 4);
+    }
+    float *out = scratch + (size_t)(sy - lo) * (size_t)dst_w * 4u;
+    for (int32_t x = 0; x < dst_w; x += 1) {
+      float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+      const int32_t *index = job->x_index + x * taps_x;
+      const float *weight = job->x_weight + x * taps_x;
+      for (int32_t t = 0; t < taps_x; t += 1) {
+        const float *texel = line + index[t] * 4;
+        float w = weight[t];
+        for (int c = 0; c < 4; c += 1) {
+          acc[c] += texel[c] * w;
+        }
+      }
+      memcpy(out + (size_t)x * 4u, acc, sizeof(acc));
+    }
+  }
+  for (int32_t y = begin; y < end; y += 1) {
+    const int32_t *index = job->y_index + y * taps_y;
+    const float *weight = job->y_weight + y * taps_y;
+    for (int32_t x = 0; x < dst_w; x += 1) {
+      float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+      for (int32_t t = 0; t < taps_y; t += 1) {
+        const float *texel =
+          scratch + ((size_t)(index[t] - lo) * (size_t)dst_w + (size_t)x) * 4u;
+        float w = weight[t];
+        for (int c = 0; c < 4; c += 1) {
+          acc[c] += texel[c] * w;
+        }
+      }
+      mgstudio_asset_mip_store(job, acc, x, y);
+    }
+  }
+  free(scratch);
+  free(line);
+}
+
+static double mgstudio_asset_mip_coverage_of(
+  const uint32_t *histogram,
+  uint32_t total,
+  double cutoff,
+  double scale
+) {
+  uint32_t passing = 0;
+  for (int a = 0; a < 256; a += 1) {
+    if ((double)a / 255.0 * scale > cutoff) {
+      passing += histogram[a];
+    }
+  }
+  return total > 0 ? (double)passing / (double)total : 0.0;
+}
+
+static float mgstudio_asset_mip_coverage(
+  const uint8_t *pixels,
+  uint32_t texels,
+  float cutoff
+) {
+  uint32_t histogram[256] = {0};
+  for (uint32_t i = 0; i < texels; i += 1) {
+    histogram[pixels[i * 4u + 3u]] += 1u;
+  }
+  return (float)mgstudio_asset_mip_coverage_of(
+    histogram, texels, (double)cutoff, 1.0
+  );
+}
+
+// Fraction of texels whose alpha passes `cutoff` (0..1).
+MOONBIT_FFI_EXPORT
+float mgstudio_asset_mip_alpha_coverage(moonbit_bytes_t pixels, float cutoff) {
+  return mgstudio_asset_mip_coverage(
+    pixels, Moonbit_array_length(pixels) / 4u, cutoff
+  );
+}
+
+// Rescales alpha so the share of texels passing `cutoff` matches
+// `target_coverage`, searching the scale on an alpha histogram.
+static void mgstudio_asset_mip_preserve_coverage(
+  uint8_t *pixels,
+  uint32_t texels,
+  double cutoff,
+  double target_coverage
+) {
+  uint32_t histogram[256] = {0};
+  for (uint32_t i = 0; i < texels; i += 1) {
+    histogram[pixels[i * 4u + 3u]] += 1u;
+  }
+  double lo = 0.0;
+  double hi = 255.0;
+  for (int i = 0; i < 32; i += 1) {
+    double mid = (lo + hi) * 0.5;
+    double coverage =
+      mgstudio_asset_mip_coverage_of(histogram, texels, cutoff, mid);
+    if (coverage < target_coverage) {
+      lo = mid;
+    } else {
+      hi = mid;
+    }
+  }
+  double scale = hi;
+  uint8_t remap[256];
+  for (int a = 0; a < 256; a += 1) {
+    double v = (double)a * scale;
+    remap[a] = (uint8_t)(v >= 255.0 ? 255.0 : v + 0.5);
+  }
+  for (uint32_t i = 0; i < texels; i += 1) {
+    pixels[i * 4u + 3u] = remap[pixels[i * 4u + 3u]];
+  }
+}
+
+// Fills `dst_w` x `dst_h` `dst` from `src_w` x `src_h` `src`. Separable
+// filters fall back to the box filter when their scratch cannot be
+// allocated, so this always produces a level.
+static void mgstudio_asset_mip_build(
+  const uint8_t *src,
+  int32_t src_w,
+  int32_t src_h,
+  uint8_t *dst,
+  int32_t dst_w,
+  int32_t dst_h,
+  int32_t srgb,
+  int32_t filter,
+  float coverage_cutoff,
+  float target_coverage
+) {
+  pthread_once(&mgstudio_asset_mip_tables_once, mgstudio_asset_mip_init_tables);
+  mgstudio_asset_mip_job_t job;
+  memset(&job, 0, sizeof(job));
+  job.src = src;
+  job.dst = dst;
+  job.src_w = src_w;
+  job.src_h = src_h;
+  job.dst_w = dst_w;
+  job.dst_h = dst_h;
+  job.srgb = srgb != 0;
+  atomic_init(&job.failed, 0);
+  int32_t grain = MGSTUDIO_ASSET_MIP_TEXELS_PER_RANGE / dst_w;
+  grain = grain < 1 ? 1 : grain;
+  int separable = filter == MGSTUDIO_ASSET_MIP_FILTER_KAISER ||
+                  filter == MGSTUDIO_ASSET_MIP_FILTER_LANCZOS;
+  if (separable) {
+    job.taps_x =
+      mgstudio_asset_mip_axis(filter, src_w, dst_w, &job.x_index, &job.x_weight);
+    job.taps_y =
+      mgstudio_asset_mip_axis(filter, src_h, dst_h, &job.y_index, &job.y_weight);
+    if (job.taps_x > 0 && job.taps_y > 0) {
+      int32_t rows = grain < MGSTUDIO_ASSET_MIP_SEPARABLE_MIN_ROWS
+                       ? MGSTUDIO_ASSET_MIP_SEPARABLE_MIN_ROWS
+                       : grain;
+      mgstudio_tasks_parallel_for(
+        dst_h, rows, mgstudio_asset_mip_separable_rows, &job
+      );
+    } else {
+      atomic_store(&job.failed, 1);
+    }
+    free(job.x_index);
+    free(job.x_weight);
+    free(job.y_index);
+    free(job.y_weight);
+  }
+  if (!separable || atomic_load(&job.failed)) {
+    mgstudio_tasks_parallel_for(dst_h, grain, mgstudio_asset_mip_box_rows, &job);
+  }
+  if (coverage_cutoff > 0.0f && coverage_cutoff < 1.0f) {
+    mgstudio_asset_mip_preserve_coverage(
+      dst, (uint32_t)dst_w * (uint32_t)dst_h, (double)coverage_cutoff,
+      (double)target_coverage
+    );
+  }
+}
+
+// Downsamples `src` (`src_w` x `src_h` RGBA8) to `dst_w` x `dst_h`. `filter`
+// is one of MGSTUDIO_ASSET_MIP_FILTER_*; `srgb` selects linear-light
+// filtering of the colour channels. A `coverage_cutoff` in (0, 1) turns on
+// alpha-coverage preservation towards `target_coverage`. Returns empty bytes
+// for invalid sizes.
+MOONBIT_FFI_EXPORT
+moonbit_bytes_t mgstudio_asset_mip_downsample(
+  moonbit_bytes_t src,
+  int32_t src_w,
+  int32_t src_h,
+  int32_t dst_w,
+  int32_t dst_h,
+  int32_t srgb,
+  int32_t filter,
+  float coverage_cutoff,
+  float target_coverage
+) {
+  if (src_w <= 0 || src_h <= 0 || dst_w <= 0 || dst_h <= 0 ||
+      dst_w > src_w || dst_h > src_h ||
+      (uint64_t)Moonbit_array_length(src) !=
+        (uint64_t)src_w * (uint64_t)src_h * 4u ||
+      (uint64_t)dst_w * (uint64_t)dst_h * 4u > (uint64_t)INT32_MAX) {
+    return moonbit_make_bytes(0, 0);
+  }
+  moonbit_bytes_t dst = moonbit_make_bytes(dst_w * dst_h * 4, 0);
+  mgstudio_asset_mip_build(
+    src, src_w, src_h, dst, dst_w, dst_h, srgb, filter, coverage_cutoff,
+    target_coverage
+  );
+  return dst;
+}
+
+typedef void (*mgstudio_tasks_job_fn)(void *arg);
+
+extern void *mgstudio_tasks_task_submit(int32_t kind,
+                                        mgstudio_tasks_job_fn run,
+                                        void *arg,
+                                        void (*free_arg)(void *arg));
+extern void mgstudio_tasks_task_complete(void *task,
+                                         uint8_t *data,
+                                         int32_t len);
+extern int32_t mgstudio_tasks_task_is_cancelled(void *task);
+extern void *mgstudio_tasks_task_arg(void *task);
+
+typedef struct {
+  uint8_t *pixels;
+  int32_t width;
+  int32_t height;
+  int32_t srgb;
+  int32_t filter;
+  float coverage_cutoff;
+} mgstudio_asset_mip_chain_input_t;
+
+static void mgstudio_asset_mip_chain_input_free(void *raw) {
+  mgstudio_asset_mip_chain_input_t *input =
+    (mgstudio_asset_mip_chain_input_t *)raw;
+  if (input != NULL) {
+    free(input->pixels);
+    free(input);
+  }
+}
+
+static inline int32_t mgstudio_asset_mip_next_dim(int32_t dim) {
+  return dim > 1 ? dim / 2 : 1;
+}
+
+// Builds every level below the base, smallest last, into one block. Each
+// level is spread over the compute pool by `mgstudio_asset_mip_build`.
+static void mgstudio_asset_mip_chain_job(void *task) {
+  mgstudio_asset_mip_chain_input_t *input =
+    (mgstudio_asset_mip_chain_input_t *)mgstudio_tasks_task_arg(task);
+  if (input == NULL || input->pixels == NULL) {
+    return;
+  }
+  uint64_t total = 0;
+  for (int32_t w = input->width, h = input->height; w > 1 || h > 1;) {
+    w = mgstudio_asset_mip_next_dim(w);
+    h = mgstudio_asset_mip_next_dim(h);
+    total += (uint64_t)w * (uint64_t)h * 4u;
+  }
+  if (total == 0 || total > (uint64_t)INT32_MAX) {
+    return;
+  }
+  uint8_t *output = (uint8_t *)malloc((size_t)total);
+  if (output == NULL) {
+    return;
+  }
+  float coverage_cutoff = input->coverage_cutoff;
+  float target_coverage = 0.0f;
+  if (coverage_cutoff > 0.0f && coverage_cutoff < 1.0f) {
+    target_coverage = mgstudio_asset_mip_coverage(
+      input->pixels,
+      (uint32_t)input->width * (uint32_t)input->height,
+      coverage_cutoff
+    );
+  }
+  const uint8_t *src = input->pixels;
+  int32_t src_w = input->width;
+  int32_t src_h = input->height;
+  uint8_t *dst = output;
+  while (src_w > 1 || src_h > 1) {
+    if (mgstudio_tasks_task_is_cancelled(task)) {
+      free(output);
+      return;
+    }
+    int32_t dst_w = mgstudio_asset_mip_next_dim(src_w);
+    int32_t dst_h = mgstudio_asset_mip_next_dim(src_h);
+    mgstudio_asset_mip_build(
+      src, src_w, src_h, dst, dst_w, dst_h, input->srgb, input->filter,
+      coverage_cutoff, target_coverage
+    );
+    src = dst;
+    src_w = dst_w;
+    src_h = dst_h;
+    dst += (size_t)dst_w * (size_t)dst_h * 4u;
+  }
+  mgstudio_tasks_task_complete(task, output, (int32_t)total);
+}
+
+// Starts building the mip chain of `pixels` on the async compute pool. The
+// job copies the pixels. The result holds levels 1.. back to back, each
+// floor-halved from the previous one.
+MOONBIT_FFI_EXPORT
+void *mgstudio_asset_mip_chain_submit(
+  moonbit_bytes_t pixels,
+  int32_t width,
+  int32_t height,
+  int32_t srgb,
+  int32_t filter,
+  float coverage_cutoff
+) {
+  mgstudio_asset_mip_chain_input_t *input = NULL;
+  uint32_t len = Moonbit_array_length(pixels);
+  if (width > 0 && height > 0 &&
+      (uint64_t)len == (uint64_t)width * (uint64_t)height * 4u) {
+    input = (mgstudio_asset_mip_chain_input_t *)malloc(
+      sizeof(mgstudio_asset_mip_chain_input_t)
+    );
+  }
+  if (input != NULL) {
+    input->pixels = (uint8_t *)malloc(len);
+    if (input->pixels != NULL) {
+      memcpy(input->pixels, pixels, len);
+    }
+    input->width = width;
+    input->height = height;
+    input->srgb = srgb;
+    input->filter = filter;
+    input->coverage_cutoff = coverage_cutoff;
+  }
+  return mgstudio_tasks_task_submit(MGSTUDIO_TASKS_POOL_ASYNC_COMPUTE,
+                                    mgstudio_asset_mip_chain_job,
+                                    input,
+                                    mgstudio_asset_mip_chain_input_free);
+}
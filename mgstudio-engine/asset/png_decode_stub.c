@@ -0,0 +1,410 @@
+// Copyright 2026 International Digital Economy Academy
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// PNG decoding for background image loads.
+//
+// Runs as a detached task on the async compute pool (see
+// `tasks/worker_pool_stub.c`): MoonBit decoders cannot run on worker threads,
+// so the asset load queue hands the file bytes to this job and picks up the
+// pixels on the frame thread. The result is an 8-byte header (width and
+// height, little endian) followed by straight-alpha RGBA8 rows, the same
+// layout the MoonBit PNG path produces. Interlaced images are rejected; the
+// caller falls back to the MoonBit decoder for them.
+
+#include <moonbit.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+#include <zlib.h>
+
+#define MGSTUDIO_TASKS_POOL_ASYNC_COMPUTE 1
+#define MGSTUDIO_ASSET_PNG_MAX_DIM 32768u
+
+typedef void (*mgstudio_tasks_job_fn)(void *arg);
+
+extern void *mgstudio_tasks_task_submit(int32_t kind,
+                                        mgstudio_tasks_job_fn run,
+                                        void *arg,
+                                        void (*free_arg)(void *arg));
+extern void mgstudio_tasks_task_complete(void *task,
+                                         uint8_t *data,
+                                         int32_t len);
+extern int32_t mgstudio_tasks_task_is_cancelled(void *task);
+extern void *mgstudio_tasks_task_arg(void *task);
+
+typedef struct {
+  uint8_t *bytes;
+  size_t len;
+} mgstudio_asset_png_input_t;
+
+static uint32_t mgstudio_asset_png_be32(const uint8_t *p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+         ((uint32_t)p[2] << 8) | (uint32_t)p[3];
+}
+
+static uint8_t mgstudio_asset_png_paeth(uint8_t a, uint8_t b, uint8_t c) {
+  int p = (int)a + (int)b - (int)c;
+  int pa = abs(p - (int)a);
+  int pb = abs(p - (int)b);
+  int pc = abs(p - (int)c);
+  if (pa <= pb && pa <= pc) {
+    return a;
+  }
+  return pb <= pc ? b : c;
+}
+
+// Reverses the per-row filters in place. `bpp` is the filter byte distance.
+static int mgstudio_asset_png_unfilter(uint8_t *data,
+                                       uint32_t height,
+                                       size_t stride,
+                                       size_t bpp) {
+  uint8_t *prev = NULL;
+  for (uint32_t y = 0; y < height; y++) {
+    uint8_t *row = data + (size_t)y * (stride + 1u);
+    uint8_t filter = row[0];
+    uint8_t *cur = row + 1;
+    switch (filter) {
+    case 0:
+      break;
+    case 1:
+      for (size_t i = bpp; i < stride; i++) {
+        cur[i] = (uint8_t)(cur[i] + cur[i - bpp]);
+      }
+      break;
+    case 2:
+      if (prev != NULL) {
+        for (size_t i = 0; i < stride; i++) {
+          cur[i] = (uint8_t)(cur[i] + prev[i]);
+        }
+      }
+      break;
+    case 3:
+      for (size_t i = 0; i < stride; i++) {
+        uint32_t left = i >= bpp ? cur[i - bpp] : 0u;
+        uint32_t up = prev != NULL ? prev[i] : 0u;
+        cur[i] = (uint8_t)(cur[i] + ((left + up) >> 1));
+      }
+      break;
+    case 4:
+      for (size_t i = 0; i < stride; i++) {
+        uint8_t left = i >= bpp ? cur[i - bpp] : 0u;
+        uint8_t up = prev != NULL ? prev[i] : 0u;
+        uint8_t up_left = (prev != NULL && i >= bpp) ? prev[i - bpp] : 0u;
+        cur[i] = (uint8_t)(cur[i] + mgstudio_asset_png_paeth(left, up, up_left));
+      }
+      break;
+    default:
+      return 0;
+    }
+    prev = cur;
+  }
+  return 1;
+}
+
+// Reads sample `index` of a row packed at `depth` bits per sample, unscaled.
+static uint32_t mgstudio_asset_png_sample(const uint8_t *row,
+                                          size_t index,
+                                          uint32_t depth) {
+  switch (depth) {
+  case 16:
+    return ((uint32_t)row[index * 2u] << 8) | row[index * 2u + 1u];
+  case 8:
+    return row[index];
+  default: {
+    size_t bit = index * depth;
+    uint32_t shift = 8u - depth - (uint32_t)(bit & 7u);
+    return (row[bit >> 3] >> shift) & ((1u << depth) - 1u);
+  }
+  }
+}
+
+// Scales an unscaled sample to 8 bits the way Go's `image/png` does: low
+// depths replicate their bits, 16-bit samples keep the high byte.
+static uint8_t mgstudio_asset_png_to8(uint32_t value, uint32_t depth) {
+  switch (depth) {
+  case 1:
+    return value ? 0xFFu : 0u;
+  case 2:
+    return (uint8_t)(value * 0x55u);
+  case 4:
+    return (uint8_t)(value * 0x11u);
+  case 16:
+    return (uint8_t)(value >> 8);
+  default:
+    return (uint8_t)value;
+  }
+}
+
+// Decodes `input` into a malloc'd header + RGBA8 buffer, or returns NULL.
+static uint8_t *mgstudio_asset_png_decode(void *task,
+                                          const uint8_t *input,
+                                          size_t input_len,
+                                          size_t *out_len) {
+  static const uint8_t signature[8] = {0x89, 0x50, 0x4E, 0x47,
+                                       0x0D, 0x0A, 0x1A, 0x0A};
+  if (input_len < 8u + 25u || memcmp(input, signature, 8) != 0) {
+    return NULL;
+  }
+  uint32_t width = 0;
+  uint32_t height = 0;
+  uint32_t depth = 0;
+  uint32_t color_type = 0;
+  uint8_t palette[256 * 4];
+  for (int i = 0; i < 256; i++) {
+    palette[i * 4] = 0;
+    palette[i * 4 + 1] = 0;
+    palette[i * 4 + 2] = 0;
+    palette[i * 4 + 3] = 0xFFu;
+  }
+  int has_key = 0;
+  uint32_t key[3] = {0, 0, 0};
+  uint8_t *idat = NULL;
+  size_t idat_len = 0;
+  size_t idat_cap = 0;
+  size_t pos = 8;
+  int seen_header = 0;
+  int seen_end = 0;
+  while (pos + 12u <= input_len) {
+    uint32_t chunk_len = mgstudio_asset_png_be32(input + pos);
+    const uint8_t *type = input + pos + 4u;
+    const uint8_t *body = input + pos + 8u;
+    if ((size_t)chunk_len > input_len - pos - 12u) {
+      break;
+    }
+    if (memcmp(type, "IHDR", 4) == 0) {
+      if (chunk_len != 13u) {
+        break;
+      }
+      width = mgstudio_asset_png_be32(body);
+      height = mgstudio_asset_png_be32(body + 4);
+      depth = body[8];
+      color_type = body[9];
+      if (body[10] != 0 || body[11] != 0 || body[12] != 0) {
+        break;
+      }
+      seen_header = 1;
+    } else if (memcmp(type, "PLTE", 4) == 0) {
+      for (uint32_t i = 0; i < chunk_len / 3u && i < 256u; i++) {
+        palette[i * 4u] = body[i * 3u];
+        palette[i * 4u + 1u] = body[i * 3u + 1u];
+        palette[i * 4u + 2u] = body[i * 3u + 2u];
+      }
+    } else if (memcmp(type, "tRNS", 4) == 0) {
+      if (color_type == 3) {
+        for (uint32_t i = 0; i < chunk_len && i < 256u; i++) {
+          palette[i * 4u + 3u] = body[i];
+        }
+      } else if (color_type == 0 && chunk_len >= 2u) {
+        has_key = 1;
+        key[0] = ((uint32_t)body[0] << 8) | body[1];
+      } else if (color_type == 2 && chunk_len >= 6u) {
+        has_key = 1;
+        for (int c = 0; c < 3; c++) {
+          key[c] = ((uint32_t)body[c * 2] << 8) | body[c * 2 + 1];
+        }
+      }
+    } else if (memcmp(type, "IDAT", 4) == 0) {
+      if (idat_len + chunk_len > idat_cap) {
+        size_t next_cap = idat_cap == 0 ? 65536u : idat_cap;
+        while (next_cap < idat_len + chunk_len) {
+          next_cap *= 2u;
+        }
+        uint8_t *grown = (uint8_t *)realloc(idat, next_cap);
+        if (grown == NULL) {
+          break;
+        }
+        idat = grown;
+        idat_cap = next_cap;
+      }
+      memcpy(idat + idat_len, body, chunk_len);
+      idat_len += chunk_len;
+    } else if (memcmp(type, "IEND", 4) == 0) {
+      seen_end = 1;
+      break;
+    }
+    pos += 12u + (size_t)chunk_len;
+  }
+  uint32_t channels = 0;
+  switch (color_type) {
+  case 0:
+  case 3:
+    channels = 1;
+    break;
+  case 2:
+    channels = 3;
+    break;
+  case 4:
+    channels = 2;
+    break;
+  case 6:
+    channels = 4;
+    break;
+  default:
+    break;
+  }
+  int depth_ok = depth == 8 || depth == 16 ||
+                 ((color_type == 0 || color_type == 3) &&
+                  (depth == 1 || depth == 2 || depth == 4));
+  if (color_type == 3 && depth == 16) {
+    depth_ok = 0;
+  }
+  if (!seen_header || !seen_end || idat_len == 0 || channels == 0 ||
+      !depth_ok || width == 0 || height == 0 ||
+      width > MGSTUDIO_ASSET_PNG_MAX_DIM ||
+      height > MGSTUDIO_ASSET_PNG_MAX_DIM) {
+    free(idat);
+    return NULL;
+  }
+  size_t bits_per_pixel = (size_t)channels * depth;
+  size_t stride = ((size_t)width * bits_per_pixel + 7u) / 8u;
+  size_t bpp = bits_per_pixel >= 8u ? bits_per_pixel / 8u : 1u;
+  size_t raw_len = (stride + 1u) * (size_t)height;
+  // Reject images whose filtered scanlines or RGBA output cannot fit a
+  // MoonBit Bytes before allocating and inflating anything. 16-bit RGBA
+  // scanlines are twice the size of the output.
+  size_t pixels_len = (size_t)width * (size_t)height * 4u;
+  if (raw_len > (size_t)INT32_MAX || pixels_len + 8u > (size_t)INT32_MAX) {
+    free(idat);
+    return NULL;
+  }
+  uint8_t *raw = (uint8_t *)malloc(raw_len);
+  if (raw == NULL) {
+    free(idat);
+    return NULL;
+  }
+  uLongf inflated_len = (uLongf)raw_len;
+  int status = uncompress(raw, &inflated_len, idat, (uLong)idat_len);
+  free(idat);
+  if (status != Z_OK || (size_t)inflated_len != raw_len ||
+      mgstudio_tasks_task_is_cancelled(task) ||
+      !mgstudio_asset_png_unfilter(raw, height, stride, bpp)) {
+    free(raw);
+    return NULL;
+  }
+  uint8_t *output = (uint8_t *)malloc(pixels_len + 8u);
+  if (output == NULL) {
+    free(raw);
+    return NULL;
+  }
+  for (int i = 0; i < 4; i++) {
+    output[i] = (uint8_t)(width >> (8 * i));
+    output[4 + i] = (uint8_t)(height >> (8 * i));
+  }
+  uint8_t *out = output + 8;
+  for (uint32_t y = 0; y < height; y++) {
+    const uint8_t *row = raw + (size_t)y * (stride + 1u) + 1u;
+    for (uint32_t x = 0; x < width; x++) {
+      size_t s = (size_t)x * channels;
+      uint8_t r, g, b, a = 0xFFu;
+      switch (color_type) {
+      case 0: {
+        uint32_t v = mgstudio_asset_png_sample(row, s, depth);
+        r = g = b = mgstudio_asset_png_to8(v, depth);
+        if (has_key && v == key[0]) {
+          a = 0;
+        }
+        break;
+      }
+      case 3: {
+        uint32_t index = mgstudio_asset_png_sample(row, s, depth);
+        r = palette[index * 4u];
+        g = palette[index * 4u + 1u];
+        b = palette[index * 4u + 2u];
+        a = palette[index * 4u + 3u];
+        break;
+      }
+      case 2: {
+        uint32_t vr = mgstudio_asset_png_sample(row, s, depth);
+        uint32_t vg = mgstudio_asset_png_sample(row, s + 1u, depth);
+        uint32_t vb = mgstudio_asset_png_sample(row, s + 2u, depth);
+        r = mgstudio_asset_png_to8(vr, depth);
+        g = mgstudio_asset_png_to8(vg, depth);
+        b = mgstudio_asset_png_to8(vb, depth);
+        if (has_key && vr == key[0] && vg == key[1] && vb == key[2]) {
+          a = 0;
+        }
+        break;
+      }
+      case 4:
+        r = g = b =
+          mgstudio_asset_png_to8(mgstudio_asset_png_sample(row, s, depth), depth);
+        a = mgstudio_asset_png_to8(
+          mgstudio_asset_png_sample(row, s + 1u, depth), depth
+        );
+        break;
+      default:
+        r = mgstudio_asset_png_to8(mgstudio_asset_png_sample(row, s, depth),
+                                   depth);
+        g = mgstudio_asset_png_to8(
+          mgstudio_asset_png_sample(row, s + 1u, depth), depth
+        );
+        b = mgstudio_asset_png_to8(
+          mgstudio_asset_png_sample(row, s + 2u, depth), depth
+        );
+        a = mgstudio_asset_png_to8(
+          mgstudio_asset_png_sample(row, s + 3u, depth), depth
+        );
+        break;
+      }
+      out[0] = r;
+      out[1] = g;
+      out[2] = b;
+      out[3] = a;
+      out += 4;
+    }
+  }
+  free(raw);
+  *out_len = pixels_len + 8u;
+  return output;
+}
+
+static void mgstudio_asset_png_input_free(void *raw) {
+  mgstudio_asset_png_input_t *input = (mgstudio_asset_png_input_t *)raw;
+  if (input != NULL) {
+    free(input->bytes);
+    free(input);
+  }
+}
+
+static void mgstudio_asset_png_decode_job(void *task) {
+  mgstudio_asset_png_input_t *input =
+    (mgstudio_asset_png_input_t *)mgstudio_tasks_task_arg(task);
+  if (input == NULL || input->bytes == NULL) {
+    return;
+  }
+  size_t len = 0;
+  uint8_t *output =
+    mgstudio_asset_png_decode(task, input->bytes, input->len, &len);
+  if (output != NULL) {
+    mgstudio_tasks_task_complete(task, output, (int32_t)len);
+  }
+}
+
+MOONBIT_FFI_EXPORT
+void *mgstudio_asset_png_decode_submit(moonbit_bytes_t bytes) {
+  uint32_t len = Moonbit_array_length(bytes);
+  mgstudio_asset_png_input_t *input =
+    (mgstudio_asset_png_input_t *)malloc(sizeof(mgstudio_asset_png_input_t));
+  if (input != NULL) {
+    input->len = len;
+    input->bytes = (uint8_t *)malloc(len > 0u ? len : 1u);
+    if (input->bytes != NULL) {
+      memcpy(input->bytes, bytes, len);
+    }
+  }
+  return mgstudio_tasks_task_submit(MGSTUDIO_TASKS_POOL_ASYNC_COMPUTE,
+                                    mgstudio_asset_png_decode_job,
+                                    input,
+                                    mgstudio_asset_png_input_free);
+}
@@ -12,13 +12,24 @@
 // See the License for the specific language governing permissions and
 // limitations under the License.
 
+// HTTP transport of the web asset source. All transfers go through one
+// curl multi handle driven by a background thread, so connections (and TLS
+// sessions) are reused across requests, several transfers run at once, and
+// submitting a request never blocks the frame thread. MoonBit polls a handle
+// per request and picks up the response once the worker published it; like
+// the task pools, the worker never calls back into MoonBit code.
+//
+// Without MGSTUDIO_ENABLE_LIBCURL every request fails immediately.
+
 #include <moonbit.h>
 #include <stdint.h>
 #include <stdlib.h>
 #include <string.h>
 
-#if defined(MGSTUDIO_ENABLE_LIBCURL)
-#include <curl/curl.h>
+#define MGSTUDIO_HTTP_PENDING 0
+#define MGSTUDIO_HTTP_DONE 1
+#define MGSTUDIO_HTTP_FAILED 2
+#define MGSTUDIO_HTTP_CANCELLED 3
 
 typedef struct {
   uint8_t *data;
@@ -26,6 +37,122 @@ typedef struct {
   size_t cap;
 } mgstudio_http_buffer_t;
 
+typedef struct mgstudio_http_transfer mgstudio_http_transfer_t;
+
+typedef struct {
+  mgstudio_http_transfer_t *transfer;
+} mgstudio_http_handle_t;
+
+static void mgstudio_asset_http_release(mgstudio_http_transfer_t *transfer);
+static int32_t mgstudio_asset_http_transfer_state(
+  mgstudio_http_transfer_t *transfer
+);
+static void mgstudio_asset_http_transfer_cancel(
+  mgstudio_http_transfer_t *transfer
+);
+
+static void mgstudio_asset_http_handle_finalize(void *ptr) {
+  mgstudio_http_handle_t *handle = (mgstudio_http_handle_t *)ptr;
+  if (handle->transfer != NULL) {
+    mgstudio_asset_http_transfer_cancel(handle->transfer);
+    mgstudio_asset_http_release(handle->transfer);
+    handle->transfer = NULL;
+  }
+}
+
+static mgstudio_http_handle_t *mgstudio_asset_http_handle_new(void) {
+  mgstudio_http_handle_t *handle =
+    (mgstudio_http_handle_t *)moonbit_make_external_object(
+      mgstudio_asset_http_handle_finalize,
+      (uint32_t)sizeof(mgstudio_http_handle_t)
+    );
+  handle->transfer = NULL;
+  return handle;
+}
+
+static moonbit_bytes_t mgstudio_asset_http_bytes_of(const uint8_t *data,
+                                                    size_t len) {
+  moonbit_bytes_t output = moonbit_make_bytes((int32_t)len, 0);
+  if (len > 0) {
+    memcpy(output, data, len);
+  }
+  return output;
+}
+
+#if defined(MGSTUDIO_ENABLE_LIBCURL)
+#include <curl/curl.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <time.h>
+
+#define MGSTUDIO_HTTP_DEFAULT_MAX_TRANSFERS 8
+#define MGSTUDIO_HTTP_DEFAULT_MAX_PER_HOST 4
+
+struct mgstudio_http_transfer {
+  atomic_int state;
+  atomic_int owners;
+  char *url;
+  struct curl_slist *headers;
+  CURL *easy;
+  mgstudio_http_buffer_t body;
+  char *etag;
+  char *last_modified;
+  long status;
+  mgstudio_http_transfer_t *next;
+};
+
+typedef struct {
+  pthread_mutex_t lock;
+  pthread_cond_t completed;
+  int started;
+  CURLM *multi;
+  CURLSH *share;
+  // Submitted but not handed to curl yet, oldest first.
+  mgstudio_http_transfer_t *queue_head;
+  mgstudio_http_transfer_t *queue_tail;
+  int32_t active;
+  int32_t max_transfers;
+  int32_t max_per_host;
+  int32_t limits_dirty;
+  uint64_t completions;
+  atomic_int_fast64_t connections;
+} mgstudio_http_client_t;
+
+static mgstudio_http_client_t mgstudio_http_client = {
+  .lock = PTHREAD_MUTEX_INITIALIZER,
+  .completed = PTHREAD_COND_INITIALIZER,
+  .max_transfers = MGSTUDIO_HTTP_DEFAULT_MAX_TRANSFERS,
+  .max_per_host = MGSTUDIO_HTTP_DEFAULT_MAX_PER_HOST,
+  .limits_dirty = 1,
+};
+
+static void mgstudio_asset_http_release(mgstudio_http_transfer_t *transfer) {
+  if (transfer == NULL || atomic_fetch_sub(&transfer->owners, 1) != 1) {
+    return;
+  }
+  free(transfer->url);
+  curl_slist_free_all(transfer->headers);
+  free(transfer->body.data);
+  free(transfer->etag);
+  free(transfer->last_modified);
+  free(transfer);
+}
+
+static int32_t mgstudio_asset_http_transfer_state(
+  mgstudio_http_transfer_t *transfer
+) {
+  return atomic_load(&transfer->state);
+}
+
+static void mgstudio_asset_http_transfer_cancel(
+  mgstudio_http_transfer_t *transfer
+) {
+  int expected = MGSTUDIO_HTTP_PENDING;
+  atomic_compare_exchange_strong(&transfer->state, &expected,
+                                 MGSTUDIO_HTTP_CANCELLED);
+}
+
+// Request header values and URLs are ASCII; anything else becomes '?'.
 static char *mgstudio_asset_ascii_cstring(moonbit_bytes_t input) {
   uint32_t len = Moonbit_array_length(input);
   char *output = (char *)malloc((size_t)len + 1u);
@@ -34,19 +161,53 @@ static char *mgstudio_asset_ascii_cstring(moonbit_bytes_t input) {
   }
   for (uint32_t i = 0; i < len; ++i) {
     uint8_t byte = input[i];
-    output[i] = (char)(byte <= 0x7Fu ? byte : '?');
+    output[i] = (char)(byte >= 0x20u && byte <= 0x7Eu ? byte : '?');
   }
   output[len] = '\0';
   return output;
 }
 
+static int mgstudio_asset_http_add_header(mgstudio_http_transfer_t *transfer,
+                                          const char *name,
+                                          moonbit_bytes_t value) {
+  if (Moonbit_array_length(value) == 0) {
+    return 1;
+  }
+  char *c_value = mgstudio_asset_ascii_cstring(value);
+  if (c_value == NULL) {
+    return 0;
+  }
+  size_t line_len = strlen(name) + strlen(c_value) + 3u;
+  char *line = (char *)malloc(line_len);
+  if (line == NULL) {
+    free(c_value);
+    return 0;
+  }
+  strcpy(line, name);
+  strcat(line, ": ");
+  strcat(line, c_value);
+  free(c_value);
+  struct curl_slist *headers = curl_slist_append(transfer->headers, line);
+  free(line);
+  if (headers == NULL) {
+    return 0;
+  }
+  transfer->headers = headers;
+  return 1;
+}
+
 static size_t mgstudio_asset_http_write_cb(
     void *contents, size_t size, size_t nmemb, void *userp) {
-  mgstudio_http_buffer_t *buffer = (mgstudio_http_buffer_t *)userp;
+  mgstudio_http_transfer_t *transfer = (mgstudio_http_transfer_t *)userp;
+  mgstudio_http_buffer_t *buffer = &transfer->body;
   size_t bytes_len = size * nmemb;
   size_t required = buffer->len + bytes_len;
+  // MoonBit byte sequences are indexed by Int.
+  if (required > (size_t)INT32_MAX) {
+    return 0;
+  }
   if (required > buffer->cap) {
-    size_t next_cap = buffer->cap == 0 ? 4096u : buffer->cap;
+    size_t next_cap = buffer->cap == 0 ? 16384u : buffer->cap;
     while (next_cap < required) {
       next_cap *= 2u;
     }
@@ -62,66 +223,451 @@ static size_t mgstudio_asset_http_write_cb(
   return bytes_len;
 }
 
-MOONBIT_FFI_EXPORT moonbit_bytes_t
-mgstudio_asset_http_fetch(moonbit_bytes_t url) {
-  static int curl_initialized = 0;
-  if (!curl_initialized) {
-    if (curl_global_init(CURL_GLOBAL_DEFAULT) != CURLE_OK) {
-      return moonbit_make_bytes(0, 0);
+// Returns the trimmed value of `line` when it is the header `name` (given in
+// lower case), otherwise NULL.
+static char *mgstudio_asset_http_header_value(const char *line,
+                                              size_t len,
+                                              const char *name) {
+  size_t name_len = strlen(name);
+  if (len <= name_len || line[name_len] != ':') {
+    return NULL;
+  }
+  for (size_t i = 0; i < name_len; ++i) {
+    char c = line[i];
+    if (c >= 'A' && c <= 'Z') {
+      c = (char)(c - 'A' + 'a');
     }
-    curl_initialized = 1;
+    if (c != name[i]) {
+      return NULL;
+    }
+  }
+  size_t begin = name_len + 1u;
+  size_t end = len;
+  while (begin < end && (line[begin] == ' ' || line[begin] == '\t')) {
+    ++begin;
+  }
+  while (end > begin && (line[end - 1] == '\r' || line[end - 1] == '\n' ||
+                         line[end - 1] == ' ' || line[end - 1] == '\t')) {
+    --end;
+  }
+  if (begin == end) {
+    return NULL;
   }
+  char *value = (char *)malloc(end - begin + 1u);
+  if (value == NULL) {
+    return NULL;
+  }
+  memcpy(value, line + begin, end - begin);
+  value[end - begin] = '\0';
+  return value;
+}
 
-  CURL *curl = curl_easy_init();
-  if (curl == NULL) {
-    return moonbit_make_bytes(0, 0);
+static size_t mgstudio_asset_http_header_cb(
+    char *line, size_t size, size_t nitems, void *userp) {
+  mgstudio_http_transfer_t *transfer = (mgstudio_http_transfer_t *)userp;
+  size_t len = size * nitems;
+  // A new status line starts another response (redirects, 100 Continue);
+  // only the validators of the final one count.
+  if (len >= 5 && memcmp(line, "HTTP/", 5) == 0) {
+    free(transfer->etag);
+    free(transfer->last_modified);
+    transfer->etag = NULL;
+    transfer->last_modified = NULL;
+    return len;
   }
+  char *value = mgstudio_asset_http_header_value(line, len, "etag");
+  if (value != NULL) {
+    free(transfer->etag);
+    transfer->etag = value;
+    return len;
+  }
+  value = mgstudio_asset_http_header_value(line, len, "last-modified");
+  if (value != NULL) {
+    free(transfer->last_modified);
+    transfer->last_modified = value;
+  }
+  return len;
+}
 
-  mgstudio_http_buffer_t buffer = {0};
-  char *url_cstr = mgstudio_asset_ascii_cstring(url);
-  if (url_cstr == NULL) {
-    curl_easy_cleanup(curl);
-    return moonbit_make_bytes(0, 0);
+// Aborts transfers whose handle was cancelled or dropped.
+static int mgstudio_asset_http_progress_cb(void *userp,
+                                           curl_off_t dltotal,
+                                           curl_off_t dlnow,
+                                           curl_off_t ultotal,
+                                           curl_off_t ulnow) {
+  (void)dltotal;
+  (void)dlnow;
+  (void)ultotal;
+  (void)ulnow;
+  mgstudio_http_transfer_t *transfer = (mgstudio_http_transfer_t *)userp;
+  return atomic_load(&transfer->state) == MGSTUDIO_HTTP_CANCELLED;
+}
+
+static int mgstudio_asset_http_start(mgstudio_http_client_t *client,
+                                     mgstudio_http_transfer_t *transfer) {
+  CURL *easy = curl_easy_init();
+  if (easy == NULL) {
+    return 0;
   }
+  curl_easy_setopt(easy, CURLOPT_URL, transfer->url);
+  curl_easy_setopt(easy, CURLOPT_SHARE, client->share);
+  curl_easy_setopt(easy, CURLOPT_PRIVATE, transfer);
+  curl_easy_setopt(easy, CURLOPT_NOSIGNAL, 1L);
+  curl_easy_setopt(easy, CURLOPT_FOLLOWLOCATION, 1L);
+  curl_easy_setopt(easy, CURLOPT_MAXREDIRS, 8L);
+  curl_easy_setopt(easy, CURLOPT_ACCEPT_ENCODING, "");
+  curl_easy_setopt(easy, CURLOPT_USERAGENT, "mgstudio-web-asset/1.0");
+  // Prefer waiting for a multiplexed HTTP/2 connection over opening another.
+  curl_easy_setopt(easy, CURLOPT_PIPEWAIT, 1L);
+  curl_easy_setopt(easy, CURLOPT_CONNECTTIMEOUT, 30L);
+  curl_easy_setopt(easy, CURLOPT_LOW_SPEED_LIMIT, 1L);
+  curl_easy_setopt(easy, CURLOPT_LOW_SPEED_TIME, 60L);
+  curl_easy_setopt(easy, CURLOPT_HTTPHEADER, transfer->headers);
+  curl_easy_setopt(easy, CURLOPT_WRITEFUNCTION, mgstudio_asset_http_write_cb);
+  curl_easy_setopt(easy, CURLOPT_WRITEDATA, transfer);
+  curl_easy_setopt(easy, CURLOPT_HEADERFUNCTION,
+                   mgstudio_asset_http_header_cb);
+  curl_easy_setopt(easy, CURLOPT_HEADERDATA, transfer);
+  curl_easy_setopt(easy, CURLOPT_NOPROGRESS, 0L);
+  curl_easy_setopt(easy, CURLOPT_XFERINFOFUNCTION,
+                   mgstudio_asset_http_progress_cb);
+  curl_easy_setopt(easy, CURLOPT_XFERINFODATA, transfer);
+  if (curl_multi_add_handle(client->multi, easy) != CURLM_OK) {
+    curl_easy_cleanup(easy);
+    return 0;
+  }
+  transfer->easy = easy;
+  return 1;
+}
 
-  curl_easy_setopt(curl, CURLOPT_URL, url_cstr);
-  curl_easy_setopt(curl, CURLOPT_FOLLOWLOCATION, 1L);
-  curl_easy_setopt(curl, CURLOPT_FAILONERROR, 1L);
-  curl_easy_setopt(curl, CURLOPT_ACCEPT_ENCODING, "");
-  curl_easy_setopt(curl, CURLOPT_USERAGENT, "mgstudio-web-asset/1.0");
-  curl_easy_setopt(curl, CURLOPT_WRITEFUNCTION, mgstudio_asset_http_write_cb);
-  curl_easy_setopt(curl, CURLOPT_WRITEDATA, &buffer);
+// Publishes the outcome of `transfer` and drops the worker's reference.
+static void mgstudio_asset_http_publish(mgstudio_http_client_t *client,
+                                        mgstudio_http_transfer_t *transfer,
+                                        int succeeded) {
+  int expected = MGSTUDIO_HTTP_PENDING;
+  atomic_compare_exchange_strong(
+    &transfer->state, &expected,
+    succeeded ? MGSTUDIO_HTTP_DONE : MGSTUDIO_HTTP_FAILED
+  );
+  pthread_mutex_lock(&client->lock);
+  client->completions += 1;
+  pthread_cond_broadcast(&client->completed);
+  pthread_mutex_unlock(&client->lock);
+  mgstudio_asset_http_release(transfer);
+}
 
-  CURLcode result = curl_easy_perform(curl);
-  long response_code = 0;
-  curl_easy_getinfo(curl, CURLINFO_RESPONSE_CODE, &response_code);
+static void mgstudio_asset_http_finish(mgstudio_http_client_t *client,
+                                       CURL *easy,
+                                       CURLcode result) {
+  mgstudio_http_transfer_t *transfer = NULL;
+  curl_easy_getinfo(easy, CURLINFO_PRIVATE, (char **)&transfer);
+  long status = 0;
+  long connects = 0;
+  curl_easy_getinfo(easy, CURLINFO_RESPONSE_CODE, &status);
+  curl_easy_getinfo(easy, CURLINFO_NUM_CONNECTS, &connects);
+  curl_multi_remove_handle(client->multi, easy);
+  curl_easy_cleanup(easy);
+  atomic_fetch_add(&client->connections, connects);
+  transfer->easy = NULL;
+  transfer->status = status;
+  pthread_mutex_lock(&client->lock);
+  client->active -= 1;
+  pthread_mutex_unlock(&client->lock);
+  mgstudio_asset_http_publish(client, transfer, result == CURLE_OK);
+}
 
-  free(url_cstr);
-  curl_easy_cleanup(curl);
+// Hands queued transfers to curl while fewer than `max_transfers` run.
+// Transfers cancelled before they started are dropped here.
+static void mgstudio_asset_http_admit(mgstudio_http_client_t *client) {
+  for (;;) {
+    pthread_mutex_lock(&client->lock);
+    if (client->limits_dirty) {
+      client->limits_dirty = 0;
+      curl_multi_setopt(client->multi, CURLMOPT_MAX_TOTAL_CONNECTIONS,
+                        (long)client->max_transfers);
+      curl_multi_setopt(client->multi, CURLMOPT_MAX_HOST_CONNECTIONS,
+                        (long)client->max_per_host);
+    }
+    mgstudio_http_transfer_t *transfer = client->queue_head;
+    if (transfer == NULL || client->active >= client->max_transfers) {
+      pthread_mutex_unlock(&client->lock);
+      return;
+    }
+    client->queue_head = transfer->next;
+    if (client->queue_head == NULL) {
+      client->queue_tail = NULL;
+    }
+    transfer->next = NULL;
+    int cancelled =
+      atomic_load(&transfer->state) == MGSTUDIO_HTTP_CANCELLED;
+    if (!cancelled) {
+      client->active += 1;
+    }
+    pthread_mutex_unlock(&client->lock);
+    if (cancelled) {
+      mgstudio_asset_http_release(transfer);
+    } else if (!mgstudio_asset_http_start(client, transfer)) {
+      pthread_mutex_lock(&client->lock);
+      client->active -= 1;
+      pthread_mutex_unlock(&client->lock);
+      mgstudio_asset_http_publish(client, transfer, 0);
+    }
+  }
+}
 
-  if (result != CURLE_OK || response_code < 200 || response_code >= 300) {
-    free(buffer.data);
-    return moonbit_make_bytes(0, 0);
+static void *mgstudio_asset_http_worker_main(void *raw) {
+  mgstudio_http_client_t *client = (mgstudio_http_client_t *)raw;
+  for (;;) {
+    mgstudio_asset_http_admit(client);
+    int running = 0;
+    curl_multi_perform(client->multi, &running);
+    int left = 0;
+    CURLMsg *message;
+    while ((message = curl_multi_info_read(client->multi, &left)) != NULL) {
+      if (message->msg == CURLMSG_DONE) {
+        mgstudio_asset_http_finish(client, message->easy_handle,
+                                   message->data.result);
+      }
+    }
+    // Submissions interrupt the wait through curl_multi_wakeup.
+    curl_multi_poll(client->multi, NULL, 0, 1000, NULL);
   }
+  return NULL;
+}
 
-  moonbit_bytes_t output = moonbit_make_bytes((int32_t)buffer.len, 0);
-  if (buffer.len > 0) {
-    memcpy(output, buffer.data, buffer.len);
+// Starts the worker on first use. Called with the client lock held.
+static int mgstudio_asset_http_start_client(mgstudio_http_client_t *client) {
+  if (client->started) {
+    return 1;
   }
-  free(buffer.data);
-  return output;
+  if (curl_global_init(CURL_GLOBAL_DEFAULT) != CURLE_OK) {
+    return 0;
+  }
+  client->multi = curl_multi_init();
+  client->share = curl_share_init();
+  if (client->multi == NULL || client->share == NULL) {
+    return 0;
+  }
+  // Only the worker uses the share, so it needs no lock callbacks.
+  curl_share_setopt(client->share, CURLSHOPT_SHARE, CURL_LOCK_DATA_DNS);
+  curl_share_setopt(client->share, CURLSHOPT_SHARE,
+                    CURL_LOCK_DATA_SSL_SESSION);
+  curl_multi_setopt(client->multi, CURLMOPT_PIPELINING,
+                    (long)CURLPIPE_MULTIPLEX);
+  pthread_t thread;
+  if (pthread_create(&thread, NULL, mgstudio_asset_http_worker_main,
+                     client) != 0) {
+    return 0;
+  }
+  pthread_detach(thread);
+  client->started = 1;
+  return 1;
+}
+
+// Queues a GET of `url`. `if_none_match` and `if_modified_since` are the
+// cached validators; empty bytes leave the header out.
+MOONBIT_FFI_EXPORT
+mgstudio_http_handle_t *mgstudio_asset_http_submit(
+  moonbit_bytes_t url,
+  moonbit_bytes_t if_none_match,
+  moonbit_bytes_t if_modified_since
+) {
+  mgstudio_http_handle_t *handle = mgstudio_asset_http_handle_new();
+  mgstudio_http_transfer_t *transfer =
+    (mgstudio_http_transfer_t *)calloc(1, sizeof(mgstudio_http_transfer_t));
+  if (transfer == NULL) {
+    return handle;
+  }
+  atomic_init(&transfer->state, MGSTUDIO_HTTP_PENDING);
+  atomic_init(&transfer->owners, 1);
+  handle->transfer = transfer;
+  transfer->url = mgstudio_asset_ascii_cstring(url);
+  if (transfer->url == NULL ||
+      !mgstudio_asset_http_add_header(transfer, "If-None-Match",
+                                      if_none_match) ||
+      !mgstudio_asset_http_add_header(transfer, "If-Modified-Since",
+                                      if_modified_since)) {
+    atomic_store(&transfer->state, MGSTUDIO_HTTP_FAILED);
+    return handle;
+  }
+  mgstudio_http_client_t *client = &mgstudio_http_client;
+  pthread_mutex_lock(&client->lock);
+  if (!mgstudio_asset_http_start_client(client)) {
+    pthread_mutex_unlock(&client->lock);
+    atomic_store(&transfer->state, MGSTUDIO_HTTP_FAILED);
+    return handle;
+  }
+  atomic_fetch_add(&transfer->owners, 1);
+  if (client->queue_tail == NULL) {
+    client->queue_head = transfer;
+  } else {
+    client->queue_tail->next = transfer;
+  }
+  client->queue_tail = transfer;
+  pthread_mutex_unlock(&client->lock);
+  curl_multi_wakeup(client->multi);
+  return handle;
+}
+
+// Caps concurrent transfers and connections per host; both at least 1.
+// Takes effect before the next transfer starts.
+MOONBIT_FFI_EXPORT
+void mgstudio_asset_http_configure(int32_t max_transfers,
+                                   int32_t max_per_host) {
+  mgstudio_http_client_t *client = &mgstudio_http_client;
+  pthread_mutex_lock(&client->lock);
+  client->max_transfers = max_transfers > 0 ? max_transfers : 1;
+  client->max_per_host = max_per_host > 0 ? max_per_host : 1;
+  client->limits_dirty = 1;
+  int started = client->started;
+  pthread_mutex_unlock(&client->lock);
+  if (started) {
+    curl_multi_wakeup(client->multi);
+  }
+}
+
+// Blocks until some transfer completes or `timeout_ms` passed.
+MOONBIT_FFI_EXPORT
+void mgstudio_asset_http_wait(int32_t timeout_ms) {
+  mgstudio_http_client_t *client = &mgstudio_http_client;
+  struct timespec deadline;
+  clock_gettime(CLOCK_REALTIME, &deadline);
+  int64_t nanos =
+    (int64_t)deadline.tv_nsec + (int64_t)(timeout_ms > 0 ? timeout_ms : 0) *
+                                  1000000;
+  deadline.tv_sec += (time_t)(nanos / 1000000000);
+  deadline.tv_nsec = (long)(nanos % 1000000000);
+  pthread_mutex_lock(&client->lock);
+  uint64_t seen = client->completions;
+  while (client->completions == seen) {
+    if (pthread_cond_timedwait(&client->completed, &client->lock,
+                               &deadline) != 0) {
+      break;
+    }
+  }
+  pthread_mutex_unlock(&client->lock);
+}
+
+// Connections opened since startup; every other transfer reused a pooled
+// connection.
+MOONBIT_FFI_EXPORT
+int64_t mgstudio_asset_http_connections_opened(void) {
+  return (int64_t)atomic_load(&mgstudio_http_client.connections);
 }
 
 MOONBIT_FFI_EXPORT int32_t mgstudio_asset_http_supported(void) { return 1; }
 
 #else
 
-MOONBIT_FFI_EXPORT moonbit_bytes_t
-mgstudio_asset_http_fetch(moonbit_bytes_t url) {
+struct mgstudio_http_transfer {
+  int32_t state;
+  long status;
+  mgstudio_http_buffer_t body;
+  char *etag;
+  char *last_modified;
+};
+
+static void mgstudio_asset_http_release(mgstudio_http_transfer_t *transfer) {
+  (void)transfer;
+}
+
+static int32_t mgstudio_asset_http_transfer_state(
+  mgstudio_http_transfer_t *transfer
+) {
+  return transfer->state;
+}
+
+static void mgstudio_asset_http_transfer_cancel(
+  mgstudio_http_transfer_t *transfer
+) {
+  (void)transfer;
+}
+
+MOONBIT_FFI_EXPORT
+mgstudio_http_handle_t *mgstudio_asset_http_submit(
+  moonbit_bytes_t url,
+  moonbit_bytes_t if_none_match,
+  moonbit_bytes_t if_modified_since
+) {
   (void)url;
-  return moonbit_make_bytes(0, 0);
+  (void)if_none_match;
+  (void)if_modified_since;
+  return mgstudio_asset_http_handle_new();
+}
+
+MOONBIT_FFI_EXPORT
+void mgstudio_asset_http_configure(int32_t max_transfers,
+                                   int32_t max_per_host) {
+  (void)max_transfers;
+  (void)max_per_host;
 }
 
+MOONBIT_FFI_EXPORT
+void mgstudio_asset_http_wait(int32_t timeout_ms) { (void)timeout_ms; }
+
+MOONBIT_FFI_EXPORT
+int64_t mgstudio_asset_http_connections_opened(void) { return 0; }
+
 MOONBIT_FFI_EXPORT int32_t mgstudio_asset_http_supported(void) { return 0; }
 
 #endif
+
+// 0 pending, 1 a response arrived, 2 failed, 3 cancelled.
+MOONBIT_FFI_EXPORT
+int32_t mgstudio_asset_http_state(mgstudio_http_handle_t *handle) {
+  if (handle->transfer == NULL) {
+    return MGSTUDIO_HTTP_FAILED;
+  }
+  return mgstudio_asset_http_transfer_state(handle->transfer);
+}
+
+MOONBIT_FFI_EXPORT
+void mgstudio_asset_http_cancel(mgstudio_http_handle_t *handle) {
+  if (handle->transfer != NULL) {
+    mgstudio_asset_http_transfer_cancel(handle->transfer);
+  }
+}
+
+static int mgstudio_asset_http_done(mgstudio_http_handle_t *handle) {
+  return handle->transfer != NULL &&
+         mgstudio_asset_http_transfer_state(handle->transfer) ==
+           MGSTUDIO_HTTP_DONE;
+}
+
+// HTTP status of the final response, or 0 before it arrived.
+MOONBIT_FFI_EXPORT
+int32_t mgstudio_asset_http_status(mgstudio_http_handle_t *handle) {
+  return mgstudio_asset_http_done(handle) ? (int32_t)handle->transfer->status
+                                          : 0;
+}
+
+// Moves the response body out of the transfer; later calls return empty
+// bytes.
+MOONBIT_FFI_EXPORT
+moonbit_bytes_t mgstudio_asset_http_take_body(mgstudio_http_handle_t *handle) {
+  if (!mgstudio_asset_http_done(handle)) {
+    return moonbit_make_bytes(0, 0);
+  }
+  mgstudio_http_buffer_t *body = &handle->transfer->body;
+  moonbit_bytes_t output = mgstudio_asset_http_bytes_of(body->data, body->len);
+  free(body->data);
+  body->data = NULL;
+  body->len = 0;
+  body->cap = 0;
+  return output;
+}
+
+// Response validator: 0 ETag, 1 Last-Modified. Empty when absent.
+MOONBIT_FFI_EXPORT
+moonbit_bytes_t mgstudio_asset_http_validator(mgstudio_http_handle_t *handle,
+                                              int32_t which) {
+  if (!mgstudio_asset_http_done(handle)) {
+    return moonbit_make_bytes(0, 0);
+  }
+  const char *value = which == 0 ? handle->transfer->etag
+                                 : handle->transfer->last_modified;
+  if (value == NULL) {
+    return moonbit_make_bytes(0, 0);
+  }
+  return mgstudio_asset_http_bytes_of((const uint8_t *)value, strlen(value));
+}
@@ -17,10 +17,42 @@
 #include <stdlib.h>
 #include <string.h>
 
+// Size-class pool for table storage. Each World owns one; the row and value
+// column kernels of its tables keep a reference and hand their arrays back
+// here instead of to the system allocator, so tables that drain and refill
+// between levels reuse blocks. Each power of two is split into four size
+// classes (32, 40, 48, 56, 64, 80, ...), so a block wastes at most a fifth of
+// its bytes and arrays of 5- or 10-word rows land on a class exactly. Freed
+// blocks are kept on per-class free lists up to `retain_limit` bytes.
+#define MGSTUDIO_ECS_RAW_TABLE_POOL_MIN_SHIFT 5
+#define MGSTUDIO_ECS_RAW_TABLE_POOL_STEPS 4
+#define MGSTUDIO_ECS_RAW_TABLE_POOL_CLASSES (27 * MGSTUDIO_ECS_RAW_TABLE_POOL_STEPS)
+
+#define MGSTUDIO_ECS_RAW_TABLE_POOL_STAT_LIVE 0
+#define MGSTUDIO_ECS_RAW_TABLE_POOL_STAT_RETAINED 1
+#define MGSTUDIO_ECS_RAW_TABLE_POOL_STAT_HITS 2
+#define MGSTUDIO_ECS_RAW_TABLE_POOL_STAT_MISSES 3
+#define MGSTUDIO_ECS_RAW_TABLE_POOL_STAT_RETAIN_LIMIT 4
+
+typedef struct mgstudio_ecs_raw_table_pool_block {
+  struct mgstudio_ecs_raw_table_pool_block *next;
+} mgstudio_ecs_raw_table_pool_block_t;
+
+typedef struct {
+  mgstudio_ecs_raw_table_pool_block_t
+    *free_lists[MGSTUDIO_ECS_RAW_TABLE_POOL_CLASSES];
+  int64_t live_bytes;
+  int64_t retained_bytes;
+  int64_t retain_limit;
+  int64_t hits;
+  int64_t misses;
+} mgstudio_ecs_raw_table_pool_t;
+
 typedef struct {
   uint64_t *data;
   int32_t len;
   int32_t cap;
+  mgstudio_ecs_raw_table_pool_t *pool;
 } mgstudio_ecs_raw_table_rows_t;
 
 typedef struct {
@@ -38,16 +70,150 @@ typedef struct {
   int32_t *changed_caller_ids;
   int32_t len;
   int32_t cap;
+  // Change summaries: the largest added/changed sequence stored in the whole
+  // column and in each chunk of MGSTUDIO_ECS_RAW_TABLE_CHUNK_ROWS rows. They
+  // only grow while rows remain (swap_remove keeps them conservative) and are
+  // reset when the column empties, so `max <= last_run` proves that no row
+  // can match a non-wrapped `Added`/`Changed` window.
+  int32_t max_added;
+  int32_t max_changed;
+  int32_t *chunk_max_added;
+  int32_t *chunk_max_changed;
+  int32_t chunk_cap;
+  mgstudio_ecs_raw_table_pool_t *pool;
 } mgstudio_ecs_raw_table_value_column_t;
 
+// One boxed value pointer plus the three metadata lanes.
+#define MGSTUDIO_ECS_RAW_TABLE_VALUE_ROW_BYTES \
+  (sizeof(void *) + 3 * sizeof(int32_t))
+
+#define MGSTUDIO_ECS_RAW_TABLE_CHUNK_SHIFT 8
+#define MGSTUDIO_ECS_RAW_TABLE_CHUNK_ROWS (1 << MGSTUDIO_ECS_RAW_TABLE_CHUNK_SHIFT)
+#define MGSTUDIO_ECS_RAW_TABLE_SCAN_ADDED 0
+#define MGSTUDIO_ECS_RAW_TABLE_SCAN_CHANGED 1
+
+static size_t mgstudio_ecs_raw_table_pool_class_bytes(int size_class) {
+  int octave = size_class / MGSTUDIO_ECS_RAW_TABLE_POOL_STEPS;
+  int step = size_class % MGSTUDIO_ECS_RAW_TABLE_POOL_STEPS;
+  return (size_t)(MGSTUDIO_ECS_RAW_TABLE_POOL_STEPS + step)
+         << (octave + MGSTUDIO_ECS_RAW_TABLE_POOL_MIN_SHIFT - 2);
+}
+
+// Smallest class whose block holds `bytes`; CLASSES when none does.
+static int mgstudio_ecs_raw_table_pool_class(size_t bytes) {
+  int octave = 0;
+  while (((size_t)1 << (octave + MGSTUDIO_ECS_RAW_TABLE_POOL_MIN_SHIFT + 1)) <
+           bytes &&
+         octave * MGSTUDIO_ECS_RAW_TABLE_POOL_STEPS <
+           MGSTUDIO_ECS_RAW_TABLE_POOL_CLASSES) {
+    octave += 1;
+  }
+  int size_class = octave * MGSTUDIO_ECS_RAW_TABLE_POOL_STEPS;
+  while (size_class < MGSTUDIO_ECS_RAW_TABLE_POOL_CLASSES &&
+         mgstudio_ecs_raw_table_pool_class_bytes(size_class) < bytes) {
+    size_class += 1;
+  }
+  return size_class;
+}
+
+// Callers pass the same `bytes` to alloc and free; both round it to the
+// block's size class. A NULL pool falls back to plain malloc/free.
+static void *mgstudio_ecs_raw_table_pool_alloc(
+  mgstudio_ecs_raw_table_pool_t *pool,
+  size_t bytes
+) {
+  if (bytes == 0) {
+    return NULL;
+  }
+  int size_class = mgstudio_ecs_raw_table_pool_class(bytes);
+  if (size_class >= MGSTUDIO_ECS_RAW_TABLE_POOL_CLASSES) {
+    return NULL;
+  }
+  size_t block_bytes = mgstudio_ecs_raw_table_pool_class_bytes(size_class);
+  if (pool == NULL) {
+    return malloc(block_bytes);
+  }
+  mgstudio_ecs_raw_table_pool_block_t *block = pool->free_lists[size_class];
+  if (block != NULL) {
+    pool->free_lists[size_class] = block->next;
+    pool->retained_bytes -= (int64_t)block_bytes;
+    pool->hits += 1;
+  } else {
+    block = (mgstudio_ecs_raw_table_pool_block_t *)malloc(block_bytes);
+    if (block == NULL) {
+      return NULL;
+    }
+    pool->misses += 1;
+  }
+  pool->live_bytes += (int64_t)block_bytes;
+  return block;
+}
+
+static void mgstudio_ecs_raw_table_pool_free(
+  mgstudio_ecs_raw_table_pool_t *pool,
+  void *ptr,
+  size_t bytes
+) {
+  if (ptr == NULL) {
+    return;
+  }
+  if (pool == NULL) {
+    free(ptr);
+    return;
+  }
+  int size_class = mgstudio_ecs_raw_table_pool_class(bytes);
+  size_t block_bytes = mgstudio_ecs_raw_table_pool_class_bytes(size_class);
+  pool->live_bytes -= (int64_t)block_bytes;
+  if (pool->retained_bytes + (int64_t)block_bytes > pool->retain_limit) {
+    free(ptr);
+    return;
+  }
+  mgstudio_ecs_raw_table_pool_block_t *block =
+    (mgstudio_ecs_raw_table_pool_block_t *)ptr;
+  block->next = pool->free_lists[size_class];
+  pool->free_lists[size_class] = block;
+  pool->retained_bytes += (int64_t)block_bytes;
+}
+
+static int64_t mgstudio_ecs_raw_table_pool_release(
+  mgstudio_ecs_raw_table_pool_t *pool,
+  int64_t keep_bytes
+) {
+  int64_t released = 0;
+  for (int size_class = MGSTUDIO_ECS_RAW_TABLE_POOL_CLASSES - 1;
+       size_class >= 0 && pool->retained_bytes > keep_bytes;
+       size_class -= 1) {
+    size_t block_bytes = mgstudio_ecs_raw_table_pool_class_bytes(size_class);
+    while (pool->free_lists[size_class] != NULL &&
+           pool->retained_bytes > keep_bytes) {
+      mgstudio_ecs_raw_table_pool_block_t *block =
+        pool->free_lists[size_class];
+      pool->free_lists[size_class] = block->next;
+      free(block);
+      pool->retained_bytes -= (int64_t)block_bytes;
+      released += (int64_t)block_bytes;
+    }
+  }
+  return released;
+}
+
+static void mgstudio_ecs_raw_table_pool_finalize(void *ptr) {
+  mgstudio_ecs_raw_table_pool_t *pool = (mgstudio_ecs_raw_table_pool_t *)ptr;
+  mgstudio_ecs_raw_table_pool_release(pool, 0);
+}
+
 static void mgstudio_ecs_raw_table_rows_finalize(void *ptr) {
   mgstudio_ecs_raw_table_rows_t *rows = (mgstudio_ecs_raw_table_rows_t *)ptr;
-  if (rows->data != NULL) {
-    free(rows->data);
-    rows->data = NULL;
-  }
+  mgstudio_ecs_raw_table_pool_free(
+    rows->pool, rows->data, (size_t)rows->cap * sizeof(uint64_t)
+  );
+  rows->data = NULL;
   rows->len = 0;
   rows->cap = 0;
+  if (rows->pool != NULL) {
+    moonbit_decref(rows->pool);
+    rows->pool = NULL;
+  }
 }
 
 static void mgstudio_ecs_raw_table_metadata_finalize(void *ptr) {
@@ -69,6 +235,43 @@ static void mgstudio_ecs_raw_table_metadata_finalize(void *ptr) {
   metadata->cap = 0;
 }
 
+static void mgstudio_ecs_raw_table_value_column_release_arrays(
+  mgstudio_ecs_raw_table_value_column_t *column
+) {
+  mgstudio_ecs_raw_table_pool_t *pool = column->pool;
+  size_t cap = (size_t)column->cap;
+  mgstudio_ecs_raw_table_pool_free(pool, column->values, cap * sizeof(void *));
+  mgstudio_ecs_raw_table_pool_free(
+    pool, column->added_sequences, cap * sizeof(int32_t)
+  );
+  mgstudio_ecs_raw_table_pool_free(
+    pool, column->changed_sequences, cap * sizeof(int32_t)
+  );
+  mgstudio_ecs_raw_table_pool_free(
+    pool, column->changed_caller_ids, cap * sizeof(int32_t)
+  );
+  column->values = NULL;
+  column->added_sequences = NULL;
+  column->changed_sequences = NULL;
+  column->changed_caller_ids = NULL;
+  column->cap = 0;
+}
+
+static void mgstudio_ecs_raw_table_value_column_release_chunks(
+  mgstudio_ecs_raw_table_value_column_t *column
+) {
+  size_t bytes = (size_t)column->chunk_cap * sizeof(int32_t);
+  mgstudio_ecs_raw_table_pool_free(
+    column->pool, column->chunk_max_added, bytes
+  );
+  mgstudio_ecs_raw_table_pool_free(
+    column->pool, column->chunk_max_changed, bytes
+  );
+  column->chunk_max_added = NULL;
+  column->chunk_max_changed = NULL;
+  column->chunk_cap = 0;
+}
+
 static void mgstudio_ecs_raw_table_value_column_finalize(void *ptr) {
   mgstudio_ecs_raw_table_value_column_t *column =
     (mgstudio_ecs_raw_table_value_column_t *)ptr;
@@ -79,23 +282,38 @@ static void mgstudio_ecs_raw_table_value_column_finalize(void *ptr) {
         column->values[i] = NULL;
       }
     }
-    free(column->values);
-    column->values = NULL;
-  }
-  if (column->added_sequences != NULL) {
-    free(column->added_sequences);
-    column->added_sequences = NULL;
   }
-  if (column->changed_sequences != NULL) {
-    free(column->changed_sequences);
-    column->changed_sequences = NULL;
+  mgstudio_ecs_raw_table_value_column_release_arrays(column);
+  mgstudio_ecs_raw_table_value_column_release_chunks(column);
+  column->len = 0;
+  if (column->pool != NULL) {
+    moonbit_decref(column->pool);
+    column->pool = NULL;
   }
-  if (column->changed_caller_ids != NULL) {
-    free(column->changed_caller_ids);
-    column->changed_caller_ids = NULL;
+}
+
+static int mgstudio_ecs_raw_table_rows_reallocate(
+  mgstudio_ecs_raw_table_rows_t *rows,
+  int32_t next_cap
+) {
+  uint64_t *next_data = NULL;
+  if (next_cap > 0) {
+    next_data = (uint64_t *)mgstudio_ecs_raw_table_pool_alloc(
+      rows->pool, (size_t)next_cap * sizeof(uint64_t)
+    );
+    if (next_data == NULL) {
+      return 0;
+    }
+    if (rows->len > 0) {
+      memcpy(next_data, rows->data, (size_t)rows->len * sizeof(uint64_t));
+    }
   }
-  column->len = 0;
-  column->cap = 0;
+  mgstudio_ecs_raw_table_pool_free(
+    rows->pool, rows->data, (size_t)rows->cap * sizeof(uint64_t)
+  );
+  rows->data = next_data;
+  rows->cap = next_cap;
+  return 1;
 }
 
 static int mgstudio_ecs_raw_table_rows_reserve(
@@ -113,14 +331,7 @@ static int mgstudio_ecs_raw_table_rows_reserve(
     }
     next_cap *= 2;
   }
-  uint64_t *grown =
-    (uint64_t *)realloc(rows->data, (size_t)next_cap * sizeof(uint64_t));
-  if (grown == NULL) {
-    return 0;
-  }
-  rows->data = grown;
-  rows->cap = next_cap;
-  return 1;
+  return mgstudio_ecs_raw_table_rows_reallocate(rows, next_cap);
 }
 
 static int mgstudio_ecs_raw_table_metadata_reserve(
@@ -178,6 +389,168 @@ static int mgstudio_ecs_raw_table_metadata_reserve(
   return 1;
 }
 
+static int mgstudio_ecs_raw_table_chunks_reallocate(
+  mgstudio_ecs_raw_table_value_column_t *column,
+  int32_t next_cap
+) {
+  if (next_cap <= 0) {
+    mgstudio_ecs_raw_table_value_column_release_chunks(column);
+    return 1;
+  }
+  size_t bytes = (size_t)next_cap * sizeof(int32_t);
+  int32_t *next_added =
+    (int32_t *)mgstudio_ecs_raw_table_pool_alloc(column->pool, bytes);
+  int32_t *next_changed =
+    (int32_t *)mgstudio_ecs_raw_table_pool_alloc(column->pool, bytes);
+  if (next_added == NULL || next_changed == NULL) {
+    mgstudio_ecs_raw_table_pool_free(column->pool, next_added, bytes);
+    mgstudio_ecs_raw_table_pool_free(column->pool, next_changed, bytes);
+    return 0;
+  }
+  int32_t keep = column->chunk_cap < next_cap ? column->chunk_cap : next_cap;
+  for (int32_t i = 0; i < next_cap; i += 1) {
+    next_added[i] = i < keep ? column->chunk_max_added[i] : -1;
+    next_changed[i] = i < keep ? column->chunk_max_changed[i] : -1;
+  }
+  mgstudio_ecs_raw_table_value_column_release_chunks(column);
+  column->chunk_max_added = next_added;
+  column->chunk_max_changed = next_changed;
+  column->chunk_cap = next_cap;
+  return 1;
+}
+
+static int mgstudio_ecs_raw_table_chunks_reserve(
+  mgstudio_ecs_raw_table_value_column_t *column,
+  int32_t rows
+) {
+  int32_t chunks = (rows + MGSTUDIO_ECS_RAW_TABLE_CHUNK_ROWS - 1) >>
+                   MGSTUDIO_ECS_RAW_TABLE_CHUNK_SHIFT;
+  if (column->chunk_cap >= chunks) {
+    return 1;
+  }
+  int32_t next_cap = column->chunk_cap > 0 ? column->chunk_cap * 2 : 4;
+  if (next_cap < chunks) {
+    next_cap = chunks;
+  }
+  return mgstudio_ecs_raw_table_chunks_reallocate(column, next_cap);
+}
+
+static void mgstudio_ecs_raw_table_summary_note(
+  mgstudio_ecs_raw_table_value_column_t *column,
+  int32_t row,
+  int32_t added_sequence,
+  int32_t changed_sequence
+) {
+  int32_t chunk = row >> MGSTUDIO_ECS_RAW_TABLE_CHUNK_SHIFT;
+  if (added_sequence > column->max_added) {
+    column->max_added = added_sequence;
+  }
+  if (changed_sequence > column->max_changed) {
+    column->max_changed = changed_sequence;
+  }
+  if (chunk < column->chunk_cap) {
+    if (added_sequence > column->chunk_max_added[chunk]) {
+      column->chunk_max_added[chunk] = added_sequence;
+    }
+    if (changed_sequence > column->chunk_max_changed[chunk]) {
+      column->chunk_max_changed[chunk] = changed_sequence;
+    }
+  }
+}
+
+static void mgstudio_ecs_raw_table_summary_reset(
+  mgstudio_ecs_raw_table_value_column_t *column
+) {
+  column->max_added = -1;
+  column->max_changed = -1;
+  for (int32_t i = 0; i < column->chunk_cap; i += 1) {
+    column->chunk_max_added[i] = -1;
+    column->chunk_max_changed[i] = -1;
+  }
+}
+
+// Same window test as `SystemSequence::contains`.
+static int mgstudio_ecs_raw_table_sequence_in_window(
+  int32_t sequence,
+  int32_t last_run,
+  int32_t this_run
+) {
+  if (sequence < 0) {
+    return 0;
+  }
+  if (this_run >= last_run) {
+    return sequence > last_run && sequence <= this_run;
+  }
+  return sequence > last_run || sequence <= this_run;
+}
+
+// Moves the live rows into freshly pooled arrays of `next_cap` rows (which
+// must be >= len) and returns the old arrays to the pool. Used for growth and
+// for shrinking alike.
+static int mgstudio_ecs_raw_table_value_column_reallocate(
+  mgstudio_ecs_raw_table_value_column_t *column,
+  int32_t next_cap
+) {
+  mgstudio_ecs_raw_table_pool_t *pool = column->pool;
+  size_t cap = (size_t)next_cap;
+  void **next_values = NULL;
+  int32_t *next_added = NULL;
+  int32_t *next_changed = NULL;
+  int32_t *next_caller_ids = NULL;
+  if (next_cap > 0) {
+    next_values = (void **)mgstudio_ecs_raw_table_pool_alloc(
+      pool, cap * sizeof(void *)
+    );
+    next_added = (int32_t *)mgstudio_ecs_raw_table_pool_alloc(
+      pool, cap * sizeof(int32_t)
+    );
+    next_changed = (int32_t *)mgstudio_ecs_raw_table_pool_alloc(
+      pool, cap * sizeof(int32_t)
+    );
+    next_caller_ids = (int32_t *)mgstudio_ecs_raw_table_pool_alloc(
+      pool, cap * sizeof(int32_t)
+    );
+    if (
+      next_values == NULL ||
+      next_added == NULL ||
+      next_changed == NULL ||
+      next_caller_ids == NULL
+    ) {
+      mgstudio_ecs_raw_table_pool_free(pool, next_values, cap * sizeof(void *));
+      mgstudio_ecs_raw_table_pool_free(pool, next_added, cap * sizeof(int32_t));
+      mgstudio_ecs_raw_table_pool_free(
+        pool, next_changed, cap * sizeof(int32_t)
+      );
+      mgstudio_ecs_raw_table_pool_free(
+        pool, next_caller_ids, cap * sizeof(int32_t)
+      );
+      return 0;
+    }
+    size_t live = (size_t)column->len;
+    if (live > 0) {
+      memcpy(next_values, column->values, live * sizeof(void *));
+      memcpy(next_added, column->added_sequences, live * sizeof(int32_t));
+      memcpy(next_changed, column->changed_sequences, live * sizeof(int32_t));
+      memcpy(
+        next_caller_ids, column->changed_caller_ids, live * sizeof(int32_t)
+      );
+    }
+    for (int32_t i = column->len; i < next_cap; i += 1) {
+      next_values[i] = NULL;
+      next_added[i] = -1;
+      next_changed[i] = -1;
+      next_caller_ids[i] = 0;
+    }
+  }
+  mgstudio_ecs_raw_table_value_column_release_arrays(column);
+  column->values = next_values;
+  column->added_sequences = next_added;
+  column->changed_sequences = next_changed;
+  column->changed_caller_ids = next_caller_ids;
+  column->cap = next_cap;
+  return 1;
+}
+
 static int mgstudio_ecs_raw_table_value_column_reserve(
   mgstudio_ecs_raw_table_value_column_t *column,
   int32_t min_cap
@@ -193,52 +566,76 @@ static int mgstudio_ecs_raw_table_value_column_reserve(
     }
     next_cap *= 2;
   }
-  void **next_values =
-    (void **)malloc((size_t)next_cap * sizeof(void *));
-  int32_t *next_added =
-    (int32_t *)malloc((size_t)next_cap * sizeof(int32_t));
-  int32_t *next_changed =
-    (int32_t *)malloc((size_t)next_cap * sizeof(int32_t));
-  int32_t *next_caller_ids =
-    (int32_t *)malloc((size_t)next_cap * sizeof(int32_t));
-  if (
-    next_values == NULL ||
-    next_added == NULL ||
-    next_changed == NULL ||
-    next_caller_ids == NULL
-  ) {
-    free(next_values);
-    free(next_added);
-    free(next_changed);
-    free(next_caller_ids);
-    return 0;
-  }
-  for (int32_t i = 0; i < column->len; i += 1) {
-    next_values[i] = column->values[i];
-    next_added[i] = column->added_sequences[i];
-    next_changed[i] = column->changed_sequences[i];
-    next_caller_ids[i] = column->changed_caller_ids[i];
-  }
-  for (int32_t i = column->len; i < next_cap; i += 1) {
-    next_values[i] = NULL;
-    next_added[i] = -1;
-    next_changed[i] = -1;
-    next_caller_ids[i] = 0;
-  }
-  free(column->values);
-  free(column->added_sequences);
-  free(column->changed_sequences);
-  free(column->changed_caller_ids);
-  column->values = next_values;
-  column->added_sequences = next_added;
-  column->changed_sequences = next_changed;
-  column->changed_caller_ids = next_caller_ids;
-  column->cap = next_cap;
-  return 1;
+  if (!mgstudio_ecs_raw_table_value_column_reallocate(column, next_cap)) {
+    return 0;
+  }
+  return mgstudio_ecs_raw_table_chunks_reserve(column, next_cap);
+}
+
+MOONBIT_FFI_EXPORT
+mgstudio_ecs_raw_table_pool_t *mgstudio_ecs_raw_table_pool_new(
+  int64_t retain_limit
+) {
+  mgstudio_ecs_raw_table_pool_t *pool =
+    (mgstudio_ecs_raw_table_pool_t *)moonbit_make_external_object(
+      mgstudio_ecs_raw_table_pool_finalize,
+      (uint32_t)sizeof(mgstudio_ecs_raw_table_pool_t)
+    );
+  memset(pool, 0, sizeof(mgstudio_ecs_raw_table_pool_t));
+  pool->retain_limit = retain_limit > 0 ? retain_limit : 0;
+  return pool;
+}
+
+// Lowers or raises the retention cap; blocks above a lowered cap are freed
+// immediately. Returns the bytes handed back to the system allocator.
+MOONBIT_FFI_EXPORT
+int64_t mgstudio_ecs_raw_table_pool_set_retain_limit(
+  mgstudio_ecs_raw_table_pool_t *pool,
+  int64_t retain_limit
+) {
+  if (pool == NULL) {
+    return 0;
+  }
+  pool->retain_limit = retain_limit > 0 ? retain_limit : 0;
+  return mgstudio_ecs_raw_table_pool_release(pool, pool->retain_limit);
+}
+
+MOONBIT_FFI_EXPORT
+int64_t mgstudio_ecs_raw_table_pool_trim(mgstudio_ecs_raw_table_pool_t *pool) {
+  if (pool == NULL) {
+    return 0;
+  }
+  return mgstudio_ecs_raw_table_pool_release(pool, 0);
+}
+
+MOONBIT_FFI_EXPORT
+int64_t mgstudio_ecs_raw_table_pool_stat(
+  mgstudio_ecs_raw_table_pool_t *pool,
+  int32_t stat
+) {
+  if (pool == NULL) {
+    return 0;
+  }
+  switch (stat) {
+  case MGSTUDIO_ECS_RAW_TABLE_POOL_STAT_LIVE:
+    return pool->live_bytes;
+  case MGSTUDIO_ECS_RAW_TABLE_POOL_STAT_RETAINED:
+    return pool->retained_bytes;
+  case MGSTUDIO_ECS_RAW_TABLE_POOL_STAT_HITS:
+    return pool->hits;
+  case MGSTUDIO_ECS_RAW_TABLE_POOL_STAT_MISSES:
+    return pool->misses;
+  case MGSTUDIO_ECS_RAW_TABLE_POOL_STAT_RETAIN_LIMIT:
+    return pool->retain_limit;
+  default:
+    return 0;
+  }
 }
 
 MOONBIT_FFI_EXPORT
-mgstudio_ecs_raw_table_rows_t *mgstudio_ecs_raw_table_rows_new(void) {
+mgstudio_ecs_raw_table_rows_t *mgstudio_ecs_raw_table_rows_new(
+  mgstudio_ecs_raw_table_pool_t *pool
+) {
   mgstudio_ecs_raw_table_rows_t *rows =
     (mgstudio_ecs_raw_table_rows_t *)moonbit_make_external_object(
       mgstudio_ecs_raw_table_rows_finalize,
@@ -247,12 +644,16 @@ mgstudio_ecs_raw_table_rows_t *mgstudio_ecs_raw_table_rows_new(void) {
   rows->data = NULL;
   rows->len = 0;
   rows->cap = 0;
+  rows->pool = pool;
+  if (pool != NULL) {
+    moonbit_incref(pool);
+  }
   return rows;
 }
 
 MOONBIT_FFI_EXPORT
 mgstudio_ecs_raw_table_value_column_t *mgstudio_ecs_raw_table_value_column_new(
-  void
+  mgstudio_ecs_raw_table_pool_t *pool
 ) {
   mgstudio_ecs_raw_table_value_column_t *column =
     (mgstudio_ecs_raw_table_value_column_t *)moonbit_make_external_object(
@@ -265,6 +666,15 @@ mgstudio_ecs_raw_table_value_column_t *mgstudio_ecs_raw_table_value_column_new(
   column->changed_caller_ids = NULL;
   column->len = 0;
   column->cap = 0;
+  column->max_added = -1;
+  column->max_changed = -1;
+  column->chunk_max_added = NULL;
+  column->chunk_max_changed = NULL;
+  column->chunk_cap = 0;
+  column->pool = pool;
+  if (pool != NULL) {
+    moonbit_incref(pool);
+  }
   return column;
 }
 
@@ -304,6 +714,133 @@ int32_t mgstudio_ecs_raw_table_value_column_len(
   return column != NULL ? column->len : 0;
 }
 
+// Batch spawns grow every kernel of the destination table once up front so
+// the per-row pushes that follow never hit the realloc path.
+MOONBIT_FFI_EXPORT
+int32_t mgstudio_ecs_raw_table_rows_reserve_additional(
+  mgstudio_ecs_raw_table_rows_t *rows,
+  int32_t additional
+) {
+  if (rows == NULL || additional < 0 || rows->len > INT32_MAX - additional) {
+    return 0;
+  }
+  return mgstudio_ecs_raw_table_rows_reserve(rows, rows->len + additional);
+}
+
+MOONBIT_FFI_EXPORT
+int32_t mgstudio_ecs_raw_table_value_column_reserve_additional(
+  mgstudio_ecs_raw_table_value_column_t *column,
+  int32_t additional
+) {
+  if (column == NULL || additional < 0 ||
+      column->len > INT32_MAX - additional) {
+    return 0;
+  }
+  return mgstudio_ecs_raw_table_value_column_reserve(
+    column, column->len + additional
+  );
+}
+
+// Capacity a kernel holding `len` rows shrinks to, or `cap` when it should
+// stay as is: the smallest power of two >= len (4 minimum, 0 when empty),
+// taken only once at least `slack_percent`% of the capacity is unused.
+static int32_t mgstudio_ecs_raw_table_shrink_target(
+  int32_t len,
+  int32_t cap,
+  int32_t slack_percent
+) {
+  if (cap == 0 || (int64_t)(cap - len) * 100 < (int64_t)slack_percent * cap) {
+    return cap;
+  }
+  if (len == 0) {
+    return 0;
+  }
+  int32_t target = 4;
+  while (target < len) {
+    target *= 2;
+  }
+  return target < cap ? target : cap;
+}
+
+MOONBIT_FFI_EXPORT
+int64_t mgstudio_ecs_raw_table_rows_bytes(
+  mgstudio_ecs_raw_table_rows_t *rows,
+  int32_t used
+) {
+  if (rows == NULL) {
+    return 0;
+  }
+  return (int64_t)(used ? rows->len : rows->cap) * (int64_t)sizeof(uint64_t);
+}
+
+MOONBIT_FFI_EXPORT
+int64_t mgstudio_ecs_raw_table_rows_shrink(
+  mgstudio_ecs_raw_table_rows_t *rows,
+  int32_t slack_percent
+) {
+  if (rows == NULL) {
+    return 0;
+  }
+  int32_t target =
+    mgstudio_ecs_raw_table_shrink_target(rows->len, rows->cap, slack_percent);
+  if (target == rows->cap) {
+    return 0;
+  }
+  int64_t before = mgstudio_ecs_raw_table_rows_bytes(rows, 0);
+  if (!mgstudio_ecs_raw_table_rows_reallocate(rows, target)) {
+    return 0;
+  }
+  return before - mgstudio_ecs_raw_table_rows_bytes(rows, 0);
+}
+
+MOONBIT_FFI_EXPORT
+int64_t mgstudio_ecs_raw_table_value_column_bytes(
+  mgstudio_ecs_raw_table_value_column_t *column,
+  int32_t used
+) {
+  if (column == NULL) {
+    return 0;
+  }
+  int64_t row_bytes = (int64_t)MGSTUDIO_ECS_RAW_TABLE_VALUE_ROW_BYTES;
+  if (used) {
+    int64_t chunks = ((int64_t)column->len + MGSTUDIO_ECS_RAW_TABLE_CHUNK_ROWS -
+                      1) >>
+                     MGSTUDIO_ECS_RAW_TABLE_CHUNK_SHIFT;
+    return (int64_t)column->len * row_bytes +
+           chunks * 2 * (int64_t)sizeof(int32_t);
+  }
+  return (int64_t)column->cap * row_bytes +
+         (int64_t)column->chunk_cap * 2 * (int64_t)sizeof(int32_t);
+}
+
+MOONBIT_FFI_EXPORT
+int64_t mgstudio_ecs_raw_table_value_column_shrink(
+  mgstudio_ecs_raw_table_value_column_t *column,
+  int32_t slack_percent
+) {
+  if (column == NULL) {
+    return 0;
+  }
+  int32_t target = mgstudio_ecs_raw_table_shrink_target(
+    column->len, column->cap, slack_percent
+  );
+  if (target == column->cap) {
+    return 0;
+  }
+  int64_t before = mgstudio_ecs_raw_table_value_column_bytes(column, 0);
+  if (!mgstudio_ecs_raw_table_value_column_reallocate(column, target)) {
+    return 0;
+  }
+  int32_t chunks = (target + MGSTUDIO_ECS_RAW_TABLE_CHUNK_ROWS - 1) >>
+                   MGSTUDIO_ECS_RAW_TABLE_CHUNK_SHIFT;
+  if (chunks < column->chunk_cap) {
+    // Dropped chunks held no live rows, so truncating keeps the summaries
+    // conservative; on failure the larger arrays simply stay.
+    (void)mgstudio_ecs_raw_table_chunks_reallocate(column, chunks);
+  }
+  return before - mgstudio_ecs_raw_table_value_column_bytes(column, 0);
+}
+
 MOONBIT_FFI_EXPORT
 int32_t mgstudio_ecs_raw_table_rows_push(
   mgstudio_ecs_raw_table_rows_t *rows,
@@ -359,6 +896,9 @@ int32_t mgstudio_ecs_raw_table_value_column_push(
   column->added_sequences[column->len] = added_sequence;
   column->changed_sequences[column->len] = changed_sequence;
   column->changed_caller_ids[column->len] = changed_caller_id;
+  mgstudio_ecs_raw_table_summary_note(
+    column, column->len, added_sequence, changed_sequence
+  );
   column->len += 1;
   return 1;
 }
@@ -405,6 +945,9 @@ int32_t mgstudio_ecs_raw_table_value_column_set_metadata(
   column->added_sequences[row] = added_sequence;
   column->changed_sequences[row] = changed_sequence;
   column->changed_caller_ids[row] = changed_caller_id;
+  mgstudio_ecs_raw_table_summary_note(
+    column, row, added_sequence, changed_sequence
+  );
   return 1;
 }
 
@@ -420,6 +963,7 @@ int32_t mgstudio_ecs_raw_table_value_column_set_changed(
   }
   column->changed_sequences[row] = changed_sequence;
   column->changed_caller_ids[row] = changed_caller_id;
+  mgstudio_ecs_raw_table_summary_note(column, row, -1, changed_sequence);
   return 1;
 }
 
@@ -445,7 +989,9 @@ void *mgstudio_ecs_raw_table_value_column_value(
   mgstudio_ecs_raw_table_value_column_t *column,
   int32_t row
 ) {
-  if (column == NULL || row < 0 || row >= column->len) {
+  if (
+    column == NULL || column->values == NULL || row < 0 || row >= column->len
+  ) {
     return NULL;
   }
   void *value = column->values[row];
@@ -590,14 +1136,96 @@ int32_t mgstudio_ecs_raw_table_value_column_swap_remove(
   }
   if (row != last_index) {
     column->values[row] = column->values[last_index];
+  }
+  column->values[last_index] = NULL;
+  if (row != last_index) {
     column->added_sequences[row] = column->added_sequences[last_index];
     column->changed_sequences[row] = column->changed_sequences[last_index];
     column->changed_caller_ids[row] = column->changed_caller_ids[last_index];
+    mgstudio_ecs_raw_table_summary_note(
+      column,
+      row,
+      column->added_sequences[row],
+      column->changed_sequences[row]
+    );
   }
-  column->values[last_index] = NULL;
   column->added_sequences[last_index] = -1;
   column->changed_sequences[last_index] = -1;
   column->changed_caller_ids[last_index] = 0;
   column->len = last_index;
+  if (column->len == 0) {
+    mgstudio_ecs_raw_table_summary_reset(column);
+  }
   return 1;
 }
+
+MOONBIT_FFI_EXPORT
+int32_t mgstudio_ecs_raw_table_value_column_max_sequence(
+  mgstudio_ecs_raw_table_value_column_t *column,
+  int32_t kind
+) {
+  if (column == NULL || column->len == 0) {
+    return -1;
+  }
+  return kind == MGSTUDIO_ECS_RAW_TABLE_SCAN_ADDED ? column->max_added
+                                                   : column->max_changed;
+}
+
+// Returns the rows whose added (kind 0) or changed (kind 1) sequence lies in
+// the `(last_run, this_run]` window, in ascending order. Chunks whose summary
+// is at or below `last_run` are skipped without touching their rows.
+MOONBIT_FFI_EXPORT
+int32_t *mgstudio_ecs_raw_table_value_column_scan(
+  mgstudio_ecs_raw_table_value_column_t *column,
+  int32_t kind,
+  int32_t last_run,
+  int32_t this_run
+) {
+  if (column == NULL || column->len == 0) {
+    return moonbit_make_int32_array(0, 0);
+  }
+  const int32_t *sequences = kind == MGSTUDIO_ECS_RAW_TABLE_SCAN_ADDED
+                               ? column->added_sequences
+                               : column->changed_sequences;
+  const int32_t *chunk_max = kind == MGSTUDIO_ECS_RAW_TABLE_SCAN_ADDED
+                               ? column->chunk_max_added
+                               : column->chunk_max_changed;
+  int skip_chunks = this_run >= last_run;
+  int32_t column_max = kind == MGSTUDIO_ECS_RAW_TABLE_SCAN_ADDED
+                         ? column->max_added
+                         : column->max_changed;
+  if (skip_chunks && column_max <= last_run) {
+    return moonbit_make_int32_array(0, 0);
+  }
+  int32_t *matches = (int32_t *)malloc((size_t)column->len * sizeof(int32_t));
+  if (matches == NULL) {
+    return moonbit_make_int32_array(0, 0);
+  }
+  int32_t count = 0;
+  for (int32_t start = 0; start < column->len;
+       start += MGSTUDIO_ECS_RAW_TABLE_CHUNK_ROWS) {
+    int32_t chunk = start >> MGSTUDIO_ECS_RAW_TABLE_CHUNK_SHIFT;
+    if (skip_chunks && chunk < column->chunk_cap &&
+        chunk_max[chunk] <= last_run) {
+      continue;
+    }
+    int32_t end = start + MGSTUDIO_ECS_RAW_TABLE_CHUNK_ROWS;
+    if (end > column->len) {
+      end = column->len;
+    }
+    for (int32_t row = start; row < end; row += 1) {
+      if (mgstudio_ecs_raw_table_sequence_in_window(
+            sequences[row], last_run, this_run
+          )) {
+        matches[count] = row;
+        count += 1;
+      }
+    }
+  }
+  int32_t *result = moonbit_make_int32_array(count, 0);
+  if (count > 0) {
+    memcpy(result, matches, (size_t)count * sizeof(int32_t));
+  }
+  free(matches);
+  return result;
+}
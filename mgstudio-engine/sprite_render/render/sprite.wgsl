@@ -9,6 +9,9 @@
 
 #import bevy_sprite::sprite_view_bindings::view
 
+// The texture is a single-channel coverage mask (an R8 glyph page).
+const COVERAGE: u32 = 1u;
+
 struct VertexInput {
     @builtin(vertex_index) index: u32,
     // NOTE: Instance-rate vertex buffer members prefixed with i_
@@ -19,12 +22,14 @@ struct VertexInput {
     @location(2) i_model_transpose_col2: vec4<f32>,
     @location(3) i_color: vec4<f32>,
     @location(4) i_uv_offset_scale: vec4<f32>,
+    @location(5) i_flags: u32,
 }
 
 struct VertexOutput {
     @builtin(position) clip_position: vec4<f32>,
     @location(0) uv: vec2<f32>,
     @location(1) @interpolate(flat) color: vec4<f32>,
+    @location(2) @interpolate(flat) flags: u32,
 };
 
 @vertex
@@ -44,6 +49,7 @@ fn vertex(in: VertexInput) -> VertexOutput {
     )) * vec4<f32>(vertex_position, 1.0);
     out.uv = vec2<f32>(vertex_position.xy) * in.i_uv_offset_scale.zw + in.i_uv_offset_scale.xy;
     out.color = in.i_color;
+    out.flags = in.i_flags;
 
     return out;
 }
@@ -53,7 +59,10 @@ fn vertex(in: VertexInput) -> VertexOutput {
 
 @fragment
 fn fragment(in: VertexOutput) -> @location(0) vec4<f32> {
-    var color = in.color * textureSample(sprite_texture, sprite_sampler, in.uv);
+    let texel = textureSample(sprite_texture, sprite_sampler, in.uv);
+    // Coverage masks only carry alpha in `.r`; the tint supplies the color.
+    let texture_color = select(texel, vec4(1.0, 1.0, 1.0, texel.r), (in.flags & COVERAGE) != 0u);
+    var color = in.color * texture_color;
 
 #ifdef TONEMAP_IN_SHADER
     color = tonemapping::tone_mapping(color, view.color_grading);
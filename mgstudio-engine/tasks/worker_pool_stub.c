@@ -0,0 +1,813 @@
+// Copyright 2026 International Digital Economy Academy
+//
+// Licensed under the Apache License, Version 2.0 (the "License");
+// you may not use this file except in compliance with the License.
+// You may obtain a copy of the License at
+//
+//     http://www.apache.org/licenses/LICENSE-2.0
+//
+// Unless required by applicable law or agreed to in writing, software
+// distributed under the License is distributed on an "AS IS" BASIS,
+// WITHOUT WARRANTIES OR CONDITIONS OF ANY KIND, either express or implied.
+// See the License for the specific language governing permissions and
+// limitations under the License.
+
+// Native worker pools shared by every `*_stub.c` kernel in the engine.
+//
+// MoonBit objects use non-atomic reference counting, so worker threads never
+// call back into MoonBit code. Jobs are plain C function pointers operating on
+// raw buffers (table columns, pixel rows, file payloads). MoonBit code drives
+// the pools through scopes and task handles:
+//
+// - a scope collects every compute job spawned while it is open, and joining
+//   it blocks (while helping) until all of them finished;
+// - a task handle tracks one detached job whose result bytes are picked up by
+//   polling from the main thread.
+//
+// There are three pools mirroring Bevy's `ComputeTaskPool`,
+// `AsyncComputeTaskPool` and `IoTaskPool`. Each worker owns a deque: jobs
+// spawned from a worker go to its own deque and are popped LIFO, idle workers
+// steal FIFO from their siblings, and jobs submitted from outside the pool go
+// through a shared injector queue.
+
+#include <moonbit.h>
+#include <pthread.h>
+#include <stdatomic.h>
+#include <stdint.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#define MGSTUDIO_TASKS_POOL_COMPUTE 0
+#define MGSTUDIO_TASKS_POOL_ASYNC_COMPUTE 1
+#define MGSTUDIO_TASKS_POOL_IO 2
+#define MGSTUDIO_TASKS_POOL_COUNT 3
+#define MGSTUDIO_TASKS_MAX_WORKERS 64
+
+#define MGSTUDIO_TASKS_TASK_PENDING 0
+#define MGSTUDIO_TASKS_TASK_DONE 1
+#define MGSTUDIO_TASKS_TASK_FAILED 2
+#define MGSTUDIO_TASKS_TASK_CANCELLED 3
+
+typedef void (*mgstudio_tasks_job_fn)(void *arg);
+typedef void (*mgstudio_tasks_range_fn)(void *arg, int32_t begin, int32_t end);
+
+typedef struct mgstudio_tasks_scope {
+  atomic_int pending;
+  struct mgstudio_tasks_scope *parent;
+  // Deferred scopes open on the thread when this one was opened, and whether
+  // this one was materialized for the innermost of them by a spawn.
+  int32_t depth;
+  int32_t lazy;
+} mgstudio_tasks_scope_t;
+
+typedef struct mgstudio_tasks_job {
+  mgstudio_tasks_job_fn run;
+  void *arg;
+  mgstudio_tasks_scope_t *scope;
+  struct mgstudio_tasks_job *prev;
+  struct mgstudio_tasks_job *next;
+} mgstudio_tasks_job_t;
+
+typedef struct {
+  pthread_mutex_t lock;
+  mgstudio_tasks_job_t *head;
+  mgstudio_tasks_job_t *tail;
+} mgstudio_tasks_deque_t;
+
+struct mgstudio_tasks_pool;
+
+typedef struct {
+  struct mgstudio_tasks_pool *pool;
+  int32_t index;
+  uint32_t steal_seed;
+} mgstudio_tasks_worker_t;
+
+typedef struct mgstudio_tasks_pool {
+  pthread_mutex_t sleep_lock;
+  pthread_cond_t wake;
+  pthread_cond_t idle;
+  atomic_int queued;
+  mgstudio_tasks_deque_t injector;
+  mgstudio_tasks_deque_t deques[MGSTUDIO_TASKS_MAX_WORKERS];
+  mgstudio_tasks_worker_t workers[MGSTUDIO_TASKS_MAX_WORKERS];
+  atomic_int thread_count;
+  int32_t requested_threads;
+  atomic_int initialized;
+} mgstudio_tasks_pool_t;
+
+static mgstudio_tasks_pool_t mgstudio_tasks_pools[MGSTUDIO_TASKS_POOL_COUNT];
+static pthread_mutex_t mgstudio_tasks_init_lock = PTHREAD_MUTEX_INITIALIZER;
+static _Thread_local mgstudio_tasks_scope_t *mgstudio_tasks_current_scope =
+  NULL;
+// Scopes opened with `mgstudio_tasks_scope_defer` and not settled yet. Only
+// the first spawn under one allocates a real scope for it.
+static _Thread_local int32_t mgstudio_tasks_deferred_depth = 0;
+static _Thread_local mgstudio_tasks_worker_t *mgstudio_tasks_current_worker =
+  NULL;
+
+static uint64_t mgstudio_tasks_now_ns(void) {
+  struct timespec ts;
+  clock_gettime(CLOCK_MONOTONIC, &ts);
+  return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+}
+
+static int32_t mgstudio_tasks_cpu_count(void) {
+  long count = sysconf(_SC_NPROCESSORS_ONLN);
+  if (count < 1) {
+    return 1;
+  }
+  if (count > MGSTUDIO_TASKS_MAX_WORKERS) {
+    return MGSTUDIO_TASKS_MAX_WORKERS;
+  }
+  return (int32_t)count;
+}
+
+static int32_t mgstudio_tasks_default_threads(int32_t kind) {
+  int32_t cpus = mgstudio_tasks_cpu_count();
+  switch (kind) {
+  case MGSTUDIO_TASKS_POOL_ASYNC_COMPUTE:
+  case MGSTUDIO_TASKS_POOL_IO: {
+    // Mirrors `TaskPoolThreadAssignmentPolicy::default_io/async_compute`:
+    // a quarter of the cores, clamped to [1, 4].
+    int32_t threads = cpus / 4;
+    return threads < 1 ? 1 : (threads > 4 ? 4 : threads);
+  }
+  default:
+    // The thread waiting on a compute scope helps, so one core is already
+    // accounted for.
+    return cpus - 1;
+  }
+}
+
+static void mgstudio_tasks_deque_push_back(mgstudio_tasks_deque_t *deque,
+                                           mgstudio_tasks_job_t *job) {
+  pthread_mutex_lock(&deque->lock);
+  job->next = NULL;
+  job->prev = deque->tail;
+  if (deque->tail != NULL) {
+    deque->tail->next = job;
+  } else {
+    deque->head = job;
+  }
+  deque->tail = job;
+  pthread_mutex_unlock(&deque->lock);
+}
+
+static mgstudio_tasks_job_t *mgstudio_tasks_deque_pop_back(
+  mgstudio_tasks_deque_t *deque
+) {
+  pthread_mutex_lock(&deque->lock);
+  mgstudio_tasks_job_t *job = deque->tail;
+  if (job != NULL) {
+    deque->tail = job->prev;
+    if (deque->tail != NULL) {
+      deque->tail->next = NULL;
+    } else {
+      deque->head = NULL;
+    }
+  }
+  pthread_mutex_unlock(&deque->lock);
+  return job;
+}
+
+static mgstudio_tasks_job_t *mgstudio_tasks_deque_pop_front(
+  mgstudio_tasks_deque_t *deque
+) {
+  pthread_mutex_lock(&deque->lock);
+  mgstudio_tasks_job_t *job = deque->head;
+  if (job != NULL) {
+    deque->head = job->next;
+    if (deque->head != NULL) {
+      deque->head->prev = NULL;
+    } else {
+      deque->tail = NULL;
+    }
+  }
+  pthread_mutex_unlock(&deque->lock);
+  return job;
+}
+
+// Takes the next job for `self` (NULL for a helping non-worker thread): own
+// deque first, then the injector, then a steal from a sibling.
+static mgstudio_tasks_job_t *mgstudio_tasks_find_job(
+  mgstudio_tasks_pool_t *pool,
+  mgstudio_tasks_worker_t *self
+) {
+  if (atomic_load(&pool->queued) == 0) {
+    return NULL;
+  }
+  mgstudio_tasks_job_t *job = NULL;
+  if (self != NULL) {
+    job = mgstudio_tasks_deque_pop_back(&pool->deques[self->index]);
+  }
+  if (job == NULL) {
+    job = mgstudio_tasks_deque_pop_front(&pool->injector);
+  }
+  if (job == NULL) {
+    int32_t count = atomic_load(&pool->thread_count);
+    uint32_t start = 0;
+    if (self != NULL) {
+      self->steal_seed = self->steal_seed * 1103515245u + 12345u;
+      start = self->steal_seed;
+    }
+    for (int32_t i = 0; i < count && job == NULL; i += 1) {
+      int32_t victim = (int32_t)((start + (uint32_t)i) % (uint32_t)count);
+      if (self != NULL && victim == self->index) {
+        continue;
+      }
+      job = mgstudio_tasks_deque_pop_front(&pool->deques[victim]);
+    }
+  }
+  if (job != NULL) {
+    atomic_fetch_sub(&pool->queued, 1);
+  }
+  return job;
+}
+
+static void mgstudio_tasks_job_finish(mgstudio_tasks_pool_t *pool,
+                                      mgstudio_tasks_job_t *job) {
+  mgstudio_tasks_scope_t *scope = job->scope;
+  free(job);
+  if (scope != NULL && atomic_fetch_sub(&scope->pending, 1) == 1) {
+    pthread_mutex_lock(&pool->sleep_lock);
+    pthread_cond_broadcast(&pool->idle);
+    pthread_mutex_unlock(&pool->sleep_lock);
+  }
+}
+
+static void *mgstudio_tasks_worker_main(void *raw) {
+  mgstudio_tasks_worker_t *self = (mgstudio_tasks_worker_t *)raw;
+  mgstudio_tasks_pool_t *pool = self->pool;
+  mgstudio_tasks_current_worker = self;
+  for (;;) {
+    mgstudio_tasks_job_t *job = mgstudio_tasks_find_job(pool, self);
+    if (job == NULL) {
+      pthread_mutex_lock(&pool->sleep_lock);
+      while (atomic_load(&pool->queued) == 0) {
+        pthread_cond_wait(&pool->wake, &pool->sleep_lock);
+      }
+      pthread_mutex_unlock(&pool->sleep_lock);
+      continue;
+    }
+    job->run(job->arg);
+    mgstudio_tasks_job_finish(pool, job);
+  }
+  return NULL;
+}
+
+// Starts workers until the pool has `wanted` threads. Pools only grow; a
+// smaller request after startup keeps the existing workers.
+static void mgstudio_tasks_pool_grow_locked(mgstudio_tasks_pool_t *pool,
+                                            int32_t wanted) {
+  if (wanted > MGSTUDIO_TASKS_MAX_WORKERS) {
+    wanted = MGSTUDIO_TASKS_MAX_WORKERS;
+  }
+  int32_t count = atomic_load(&pool->thread_count);
+  while (count < wanted) {
+    mgstudio_tasks_worker_t *worker = &pool->workers[count];
+    worker->pool = pool;
+    worker->index = count;
+    worker->steal_seed = (uint32_t)count * 2654435761u + 1u;
+    pthread_mutex_init(&pool->deques[count].lock, NULL);
+    pool->deques[count].head = NULL;
+    pool->deques[count].tail = NULL;
+    pthread_t thread;
+    if (pthread_create(&thread, NULL, mgstudio_tasks_worker_main, worker) !=
+        0) {
+      break;
+    }
+    pthread_detach(thread);
+    count += 1;
+    atomic_store(&pool->thread_count, count);
+  }
+}
+
+static mgstudio_tasks_pool_t *mgstudio_tasks_pool_get(int32_t kind) {
+  if (kind < 0 || kind >= MGSTUDIO_TASKS_POOL_COUNT) {
+    kind = MGSTUDIO_TASKS_POOL_COMPUTE;
+  }
+  mgstudio_tasks_pool_t *pool = &mgstudio_tasks_pools[kind];
+  if (atomic_load(&pool->initialized)) {
+    return pool;
+  }
+  pthread_mutex_lock(&mgstudio_tasks_init_lock);
+  if (!atomic_load(&pool->initialized)) {
+    pthread_mutex_init(&pool->sleep_lock, NULL);
+    pthread_cond_init(&pool->wake, NULL);
+    pthread_cond_init(&pool->idle, NULL);
+    pthread_mutex_init(&pool->injector.lock, NULL);
+    pool->injector.head = NULL;
+    pool->injector.tail = NULL;
+    atomic_init(&pool->queued, 0);
+    atomic_init(&pool->thread_count, 0);
+    int32_t wanted = pool->requested_threads > 0
+                       ? pool->requested_threads
+                       : mgstudio_tasks_default_threads(kind);
+    mgstudio_tasks_pool_grow_locked(pool, wanted);
+    atomic_store(&pool->initialized, 1);
+  }
+  pthread_mutex_unlock(&mgstudio_tasks_init_lock);
+  return pool;
+}
+
+static void mgstudio_tasks_enqueue(mgstudio_tasks_pool_t *pool,
+                                   mgstudio_tasks_job_t *job) {
+  mgstudio_tasks_worker_t *self = mgstudio_tasks_current_worker;
+  if (self != NULL && self->pool == pool) {
+    mgstudio_tasks_deque_push_back(&pool->deques[self->index], job);
+  } else {
+    mgstudio_tasks_deque_push_back(&pool->injector, job);
+  }
+  atomic_fetch_add(&pool->queued, 1);
+  pthread_mutex_lock(&pool->sleep_lock);
+  pthread_cond_signal(&pool->wake);
+  pthread_mutex_unlock(&pool->sleep_lock);
+}
+
+static int32_t mgstudio_tasks_spawn_on(int32_t kind,
+                                       mgstudio_tasks_job_fn run,
+                                       void *arg,
+                                       mgstudio_tasks_scope_t *scope) {
+  mgstudio_tasks_pool_t *pool = mgstudio_tasks_pool_get(kind);
+  mgstudio_tasks_job_t *job = NULL;
+  if (atomic_load(&pool->thread_count) > 0) {
+    job = (mgstudio_tasks_job_t *)malloc(sizeof(mgstudio_tasks_job_t));
+  }
+  if (job == NULL) {
+    run(arg);
+    return 0;
+  }
+  job->run = run;
+  job->arg = arg;
+  job->scope = scope;
+  job->prev = NULL;
+  job->next = NULL;
+  if (scope != NULL) {
+    atomic_fetch_add(&scope->pending, 1);
+  }
+  mgstudio_tasks_enqueue(pool, job);
+  return 1;
+}
+
+static void mgstudio_tasks_scope_wait(mgstudio_tasks_pool_t *pool,
+                                      mgstudio_tasks_scope_t *scope) {
+  mgstudio_tasks_worker_t *self = mgstudio_tasks_current_worker;
+  if (self != NULL && self->pool != pool) {
+    self = NULL;
+  }
+  while (atomic_load(&scope->pending) > 0) {
+    mgstudio_tasks_job_t *job = mgstudio_tasks_find_job(pool, self);
+    if (job != NULL) {
+      job->run(job->arg);
+      mgstudio_tasks_job_finish(pool, job);
+      continue;
+    }
+    pthread_mutex_lock(&pool->sleep_lock);
+    if (atomic_load(&scope->pending) > 0 && atomic_load(&pool->queued) == 0) {
+      pthread_cond_wait(&pool->idle, &pool->sleep_lock);
+    }
+    pthread_mutex_unlock(&pool->sleep_lock);
+  }
+}
+
+// Spawns `run(arg)` on the compute pool. The job is attached to the scope
+// that is currently open on the calling thread, if any; without an open scope
+// the job is detached and nobody waits for it. Runs inline when the pool has
+// no workers or the job cannot be allocated.
+int32_t mgstudio_tasks_spawn(mgstudio_tasks_job_fn run, void *arg) {
+  mgstudio_tasks_scope_t *scope = mgstudio_tasks_current_scope;
+  int32_t depth = mgstudio_tasks_deferred_depth;
+  if (depth > 0 && (scope == NULL || scope->depth < depth)) {
+    mgstudio_tasks_scope_t *lazy =
+      (mgstudio_tasks_scope_t *)malloc(sizeof(mgstudio_tasks_scope_t));
+    if (lazy == NULL) {
+      run(arg);
+      return 0;
+    }
+    atomic_init(&lazy->pending, 0);
+    lazy->parent = scope;
+    lazy->depth = depth;
+    lazy->lazy = 1;
+    mgstudio_tasks_current_scope = lazy;
+    scope = lazy;
+  }
+  return mgstudio_tasks_spawn_on(MGSTUDIO_TASKS_POOL_COMPUTE, run, arg, scope);
+}
+
+typedef struct {
+  mgstudio_tasks_range_fn run;
+  void *arg;
+  int32_t count;
+  int32_t grain;
+  atomic_int next_chunk;
+} mgstudio_tasks_parallel_for_t;
+
+static void mgstudio_tasks_parallel_for_drain(void *raw) {
+  mgstudio_tasks_parallel_for_t *job = (mgstudio_tasks_parallel_for_t *)raw;
+  int32_t chunks = (job->count + job->grain - 1) / job->grain;
+  for (;;) {
+    int32_t chunk = atomic_fetch_add(&job->next_chunk, 1);
+    if (chunk >= chunks) {
+      return;
+    }
+    int32_t begin = chunk * job->grain;
+    int32_t end = begin + job->grain;
+    if (end > job->count) {
+      end = job->count;
+    }
+    job->run(job->arg, begin, end);
+  }
+}
+
+// Runs `run(arg, begin, end)` over `[0, count)` split into `grain`-sized
+// ranges on the compute pool and returns once every range finished. The
+// calling thread takes ranges too, so this never deadlocks when all workers
+// are busy.
+void mgstudio_tasks_parallel_for(
+  int32_t count,
+  int32_t grain,
+  mgstudio_tasks_range_fn run,
+  void *arg
+) {
+  if (count <= 0) {
+    return;
+  }
+  if (grain <= 0) {
+    grain = 1;
+  }
+  mgstudio_tasks_pool_t *pool =
+    mgstudio_tasks_pool_get(MGSTUDIO_TASKS_POOL_COMPUTE);
+  int32_t chunks = (count + grain - 1) / grain;
+  int32_t workers = atomic_load(&pool->thread_count);
+  if (chunks == 1 || workers == 0) {
+    run(arg, 0, count);
+    return;
+  }
+  mgstudio_tasks_parallel_for_t job;
+  job.run = run;
+  job.arg = arg;
+  job.count = count;
+  job.grain = grain;
+  atomic_init(&job.next_chunk, 0);
+  mgstudio_tasks_scope_t scope;
+  atomic_init(&scope.pending, 0);
+  scope.parent = NULL;
+  scope.depth = 0;
+  scope.lazy = 0;
+  int32_t helpers = chunks - 1;
+  if (helpers > workers) {
+    helpers = workers;
+  }
+  for (int32_t i = 0; i < helpers; i += 1) {
+    mgstudio_tasks_spawn_on(
+      MGSTUDIO_TASKS_POOL_COMPUTE, mgstudio_tasks_parallel_for_drain, &job,
+      &scope
+    );
+  }
+  mgstudio_tasks_parallel_for_drain(&job);
+  // Helpers that never got a chunk still reference `job`, so wait for all of
+  // them rather than only for the chunks.
+  mgstudio_tasks_scope_wait(pool, &scope);
+}
+
+typedef struct mgstudio_tasks_task {
+  atomic_int state;
+  atomic_int owners;
+  uint8_t *data;
+  int32_t len;
+  mgstudio_tasks_job_fn run;
+  void *arg;
+  void (*free_arg)(void *arg);
+} mgstudio_tasks_task_t;
+
+// Signalled whenever a detached task leaves the pending state, for
+// `mgstudio_tasks_task_wait`.
+static pthread_mutex_t mgstudio_tasks_task_done_lock =
+  PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t mgstudio_tasks_task_done = PTHREAD_COND_INITIALIZER;
+
+static void mgstudio_tasks_task_release(mgstudio_tasks_task_t *task) {
+  if (task == NULL || atomic_fetch_sub(&task->owners, 1) != 1) {
+    return;
+  }
+  if (task->free_arg != NULL) {
+    task->free_arg(task->arg);
+  }
+  free(task->data);
+  free(task);
+}
+
+// Publishes the result of a detached task. Takes ownership of `data`, which
+// must come from malloc.
+void mgstudio_tasks_task_complete(mgstudio_tasks_task_t *task,
+                                  uint8_t *data,
+                                  int32_t len) {
+  task->data = data;
+  task->len = data != NULL ? len : 0;
+  int expected = MGSTUDIO_TASKS_TASK_PENDING;
+  if (!atomic_compare_exchange_strong(&task->state, &expected,
+                                      MGSTUDIO_TASKS_TASK_DONE)) {
+    free(task->data);
+    task->data = NULL;
+    task->len = 0;
+  }
+}
+
+void mgstudio_tasks_task_fail(mgstudio_tasks_task_t *task) {
+  int expected = MGSTUDIO_TASKS_TASK_PENDING;
+  atomic_compare_exchange_strong(&task->state, &expected,
+                                 MGSTUDIO_TASKS_TASK_FAILED);
+}
+
+int32_t mgstudio_tasks_task_is_cancelled(mgstudio_tasks_task_t *task) {
+  return atomic_load(&task->state) == MGSTUDIO_TASKS_TASK_CANCELLED;
+}
+
+void *mgstudio_tasks_task_arg(mgstudio_tasks_task_t *task) {
+  return task->arg;
+}
+
+static void mgstudio_tasks_task_trampoline(void *raw) {
+  mgstudio_tasks_task_t *task = (mgstudio_tasks_task_t *)raw;
+  if (!mgstudio_tasks_task_is_cancelled(task)) {
+    task->run(task);
+    mgstudio_tasks_task_fail(task);
+  }
+  pthread_mutex_lock(&mgstudio_tasks_task_done_lock);
+  pthread_cond_broadcast(&mgstudio_tasks_task_done);
+  pthread_mutex_unlock(&mgstudio_tasks_task_done_lock);
+  mgstudio_tasks_task_release(task);
+}
+
+typedef struct {
+  mgstudio_tasks_task_t *task;
+} mgstudio_tasks_task_handle_t;
+
+static void mgstudio_tasks_task_handle_finalize(void *ptr) {
+  mgstudio_tasks_task_handle_t *handle = (mgstudio_tasks_task_handle_t *)ptr;
+  if (handle->task != NULL) {
+    int expected = MGSTUDIO_TASKS_TASK_PENDING;
+    atomic_compare_exchange_strong(&handle->task->state, &expected,
+                                   MGSTUDIO_TASKS_TASK_CANCELLED);
+    mgstudio_tasks_task_release(handle->task);
+    handle->task = NULL;
+  }
+}
+
+// Submits a detached job to pool `kind` and returns a MoonBit-owned handle.
+// `run` receives the task itself and must finish through
+// `mgstudio_tasks_task_complete` (otherwise the task is marked failed); it
+// should check `mgstudio_tasks_task_is_cancelled` between expensive steps.
+// `free_arg` releases `arg` once both the job and the handle are gone.
+mgstudio_tasks_task_handle_t *mgstudio_tasks_task_submit(
+  int32_t kind,
+  mgstudio_tasks_job_fn run,
+  void *arg,
+  void (*free_arg)(void *arg)
+) {
+  mgstudio_tasks_task_handle_t *handle =
+    (mgstudio_tasks_task_handle_t *)moonbit_make_external_object(
+      mgstudio_tasks_task_handle_finalize,
+      (uint32_t)sizeof(mgstudio_tasks_task_handle_t)
+    );
+  handle->task = NULL;
+  mgstudio_tasks_task_t *task =
+    (mgstudio_tasks_task_t *)malloc(sizeof(mgstudio_tasks_task_t));
+  if (task == NULL) {
+    if (free_arg != NULL) {
+      free_arg(arg);
+    }
+    return handle;
+  }
+  atomic_init(&task->state, MGSTUDIO_TASKS_TASK_PENDING);
+  atomic_init(&task->owners, 2);
+  task->data = NULL;
+  task->len = 0;
+  task->run = run;
+  task->arg = arg;
+  task->free_arg = free_arg;
+  handle->task = task;
+  mgstudio_tasks_spawn_on(kind, mgstudio_tasks_task_trampoline, task, NULL);
+  return handle;
+}
+
+MOONBIT_FFI_EXPORT
+int32_t mgstudio_tasks_task_state(mgstudio_tasks_task_handle_t *handle) {
+  if (handle == NULL || handle->task == NULL) {
+    return MGSTUDIO_TASKS_TASK_FAILED;
+  }
+  return atomic_load(&handle->task->state);
+}
+
+// Blocks until the task is no longer pending.
+MOONBIT_FFI_EXPORT
+void mgstudio_tasks_task_wait(mgstudio_tasks_task_handle_t *handle) {
+  if (handle == NULL || handle->task == NULL) {
+    return;
+  }
+  pthread_mutex_lock(&mgstudio_tasks_task_done_lock);
+  while (atomic_load(&handle->task->state) == MGSTUDIO_TASKS_TASK_PENDING) {
+    pthread_cond_wait(&mgstudio_tasks_task_done,
+                      &mgstudio_tasks_task_done_lock);
+  }
+  pthread_mutex_unlock(&mgstudio_tasks_task_done_lock);
+}
+
+MOONBIT_FFI_EXPORT
+void mgstudio_tasks_task_cancel(mgstudio_tasks_task_handle_t *handle) {
+  if (handle == NULL || handle->task == NULL) {
+    return;
+  }
+  int expected = MGSTUDIO_TASKS_TASK_PENDING;
+  atomic_compare_exchange_strong(&handle->task->state, &expected,
+                                 MGSTUDIO_TASKS_TASK_CANCELLED);
+}
+
+MOONBIT_FFI_EXPORT
+moonbit_bytes_t mgstudio_tasks_task_take_bytes(
+  mgstudio_tasks_task_handle_t *handle
+) {
+  if (handle == NULL || handle->task == NULL ||
+      atomic_load(&handle->task->state) != MGSTUDIO_TASKS_TASK_DONE) {
+    return moonbit_make_bytes(0, 0);
+  }
+  mgstudio_tasks_task_t *task = handle->task;
+  moonbit_bytes_t output = moonbit_make_bytes(task->len, 0);
+  if (task->len > 0) {
+    memcpy(output, task->data, (size_t)task->len);
+  }
+  free(task->data);
+  task->data = NULL;
+  task->len = 0;
+  return output;
+}
+
+static void mgstudio_tasks_read_file_job(void *raw) {
+  mgstudio_tasks_task_t *task = (mgstudio_tasks_task_t *)raw;
+  const char *path = (const char *)task->arg;
+  if (path == NULL) {
+    return;
+  }
+  FILE *file = fopen(path, "rb");
+  if (file == NULL) {
+    return;
+  }
+  uint8_t *data = NULL;
+  size_t len = 0;
+  size_t cap = 0;
+  for (;;) {
+    if (mgstudio_tasks_task_is_cancelled(task)) {
+      free(data);
+      fclose(file);
+      return;
+    }
+    if (len == cap) {
+      size_t next_cap = cap == 0 ? 65536u : cap * 2u;
+      uint8_t *grown = (uint8_t *)realloc(data, next_cap);
+      if (grown == NULL) {
+        free(data);
+        fclose(file);
+        return;
+      }
+      data = grown;
+      cap = next_cap;
+    }
+    size_t read = fread(data + len, 1, cap - len, file);
+    len += read;
+    if (read == 0) {
+      break;
+    }
+  }
+  int failed = ferror(file) || len > (size_t)INT32_MAX;
+  fclose(file);
+  if (failed) {
+    free(data);
+    return;
+  }
+  mgstudio_tasks_task_complete(task, data, (int32_t)len);
+}
+
+MOONBIT_FFI_EXPORT
+mgstudio_tasks_task_handle_t *mgstudio_tasks_io_read_file(
+  moonbit_bytes_t path
+) {
+  uint32_t len = Moonbit_array_length(path);
+  char *path_cstr = (char *)malloc((size_t)len + 1u);
+  if (path_cstr != NULL) {
+    memcpy(path_cstr, path, len);
+    path_cstr[len] = '\0';
+  }
+  return mgstudio_tasks_task_submit(
+    MGSTUDIO_TASKS_POOL_IO, mgstudio_tasks_read_file_job, path_cstr, free
+  );
+}
+
+MOONBIT_FFI_EXPORT
+int32_t mgstudio_tasks_available_parallelism(void) {
+  return mgstudio_tasks_cpu_count();
+}
+
+MOONBIT_FFI_EXPORT
+int64_t mgstudio_tasks_now_us(void) {
+  return (int64_t)(mgstudio_tasks_now_ns() / 1000u);
+}
+
+MOONBIT_FFI_EXPORT
+int32_t mgstudio_tasks_pool_configure(int32_t kind, int32_t threads) {
+  if (kind < 0 || kind >= MGSTUDIO_TASKS_POOL_COUNT) {
+    return 0;
+  }
+  mgstudio_tasks_pool_t *pool = &mgstudio_tasks_pools[kind];
+  pthread_mutex_lock(&mgstudio_tasks_init_lock);
+  pool->requested_threads = threads;
+  if (atomic_load(&pool->initialized)) {
+    mgstudio_tasks_pool_grow_locked(pool, threads);
+  }
+  pthread_mutex_unlock(&mgstudio_tasks_init_lock);
+  return atomic_load(&mgstudio_tasks_pool_get(kind)->thread_count);
+}
+
+MOONBIT_FFI_EXPORT
+int32_t mgstudio_tasks_pool_thread_count(int32_t kind) {
+  return atomic_load(&mgstudio_tasks_pool_get(kind)->thread_count);
+}
+
+// A scope dropped without `join` must neither stay reachable as the
+// thread's current scope nor be freed under jobs that still count on it.
+static void mgstudio_tasks_scope_finalize(void *ptr) {
+  mgstudio_tasks_scope_t *scope = (mgstudio_tasks_scope_t *)ptr;
+  mgstudio_tasks_scope_t **link = &mgstudio_tasks_current_scope;
+  while (*link != NULL) {
+    if (*link == scope) {
+      *link = scope->parent;
+      break;
+    }
+    link = &(*link)->parent;
+  }
+  if (atomic_load(&scope->pending) > 0) {
+    mgstudio_tasks_scope_wait(
+      mgstudio_tasks_pool_get(MGSTUDIO_TASKS_POOL_COMPUTE), scope
+    );
+  }
+}
+
+MOONBIT_FFI_EXPORT
+mgstudio_tasks_scope_t *mgstudio_tasks_scope_begin(void) {
+  mgstudio_tasks_scope_t *scope =
+    (mgstudio_tasks_scope_t *)moonbit_make_external_object(
+      mgstudio_tasks_scope_finalize,
+      (uint32_t)sizeof(mgstudio_tasks_scope_t)
+    );
+  atomic_init(&scope->pending, 0);
+  scope->parent = mgstudio_tasks_current_scope;
+  scope->depth = mgstudio_tasks_deferred_depth;
+  scope->lazy = 0;
+  mgstudio_tasks_current_scope = scope;
+  return scope;
+}
+
+// Opens a scope that costs nothing until a job is spawned under it.
+MOONBIT_FFI_EXPORT
+void mgstudio_tasks_scope_defer(void) {
+  mgstudio_tasks_deferred_depth += 1;
+}
+
+// Closes the innermost deferred scope, joining its jobs if any were spawned.
+MOONBIT_FFI_EXPORT
+void mgstudio_tasks_scope_settle(void) {
+  int32_t depth = mgstudio_tasks_deferred_depth;
+  if (depth == 0) {
+    return;
+  }
+  mgstudio_tasks_deferred_depth = depth - 1;
+  mgstudio_tasks_scope_t *scope = mgstudio_tasks_current_scope;
+  if (scope == NULL || !scope->lazy || scope->depth != depth) {
+    return;
+  }
+  mgstudio_tasks_current_scope = scope->parent;
+  mgstudio_tasks_scope_wait(
+    mgstudio_tasks_pool_get(MGSTUDIO_TASKS_POOL_COMPUTE), scope
+  );
+  free(scope);
+}
+
+MOONBIT_FFI_EXPORT
+int32_t mgstudio_tasks_scope_pending(mgstudio_tasks_scope_t *scope) {
+  return scope != NULL ? atomic_load(&scope->pending) : 0;
+}
+
+MOONBIT_FFI_EXPORT
+void mgstudio_tasks_scope_join(mgstudio_tasks_scope_t *scope) {
+  if (scope == NULL) {
+    return;
+  }
+  if (mgstudio_tasks_current_scope == scope) {
+    mgstudio_tasks_current_scope = scope->parent;
+  }
+  mgstudio_tasks_scope_wait(
+    mgstudio_tasks_pool_get(MGSTUDIO_TASKS_POOL_COMPUTE), scope
+  );
+}
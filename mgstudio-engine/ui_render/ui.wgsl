@@ -5,6 +5,8 @@
 const TEXTURED = 1u;
 const RIGHT_VERTEX = 2u;
 const BOTTOM_VERTEX = 4u;
+// The texture is a single-channel coverage mask (an R8 glyph page).
+const COVERAGE = 8u;
 // must align with BORDER_* shader_flags from bevy_ui/render/mod.rs
 const BORDER_LEFT: u32 = 256u;
 const BORDER_TOP: u32 = 512u;
@@ -212,7 +214,9 @@ fn draw_uinode_background(
 
 @fragment
 fn fragment(in: VertexOutput) -> @location(0) vec4<f32> {
-    let texture_color = textureSample(sprite_texture, sprite_sampler, in.uv);
+    let texel = textureSample(sprite_texture, sprite_sampler, in.uv);
+    // Coverage masks only carry alpha in `.r`; the node color supplies the color.
+    let texture_color = select(texel, vec4(1.0, 1.0, 1.0, texel.r), enabled(in.flags, COVERAGE));
 
     // Only use the color sampled from the texture if the `TEXTURED` flag is enabled. 
     // This allows us to draw both textured and untextured shapes together in the same batch.